@@ -1,6 +1,9 @@
 #include "Board.h"
 #include "Bitboard.h"
+#include "Move.h"
+#include "Evaluation.h"
 #include <sstream>
+#include <cassert>
 #include <cstdlib>
 #include <iostream>
 #include <vector>
@@ -21,6 +24,9 @@ ChessBoard::ChessBoard() {
     blackQueensideCastling = true;
     moveHistory.clear();
     zobristHash = 0;
+    pawnHash = 0;
+    material = 0;
+    psqScore.fill(0);
     halfMoveCount = 0;
     fullMoveCount = 0;
     whiteHasCastled = false;
@@ -29,7 +35,8 @@ ChessBoard::ChessBoard() {
 }
 
 void ChessBoard::initializeStartingPosition() {
-    zobristHash = 0;
+    material = 0;
+    psqScore.fill(0);
     squareArray = {
         wR, wN, wB, wQ, wK, wB, wN, wR,
         wP, wP, wP, wP, wP, wP, wP, wP,
@@ -54,13 +61,21 @@ void ChessBoard::initializeStartingPosition() {
     whiteQueensideCastling = true;
     blackKingsideCastling = true;
     blackQueensideCastling = true;
-    zobristHash ^= turnHash;
+    zobristHash = computeHash();
+    pawnHash = computePawnHash();
 }
 
 void ChessBoard::initializeFEN(const std::string &fen) {
-    zobristHash = 0;
+    pieceBitboards.fill(0);
+    colorBitboards.fill(0);
+    material = 0;
+    psqScore.fill(0);
     for (Square s = a1; s <= h8; s = Square(s + 1))
         placePiece(EMPTY, s, WHITE);
+    whiteKingsideCastling = false;
+    whiteQueensideCastling = false;
+    blackKingsideCastling = false;
+    blackQueensideCastling = false;
     std::istringstream iss(fen);
     std::string piecesStr, turnStr, castling, enpass, halfMoveClock, fullMoveCountStr;
     iss >> piecesStr >> turnStr >> castling >> enpass >> halfMoveClock >> fullMoveCountStr;
@@ -106,14 +121,70 @@ void ChessBoard::initializeFEN(const std::string &fen) {
         enPassantSquare = stringToSquareMap[enpass];
     halfMoveCount = std::atoi(halfMoveClock.c_str());
     fullMoveCount = std::atoi(fullMoveCountStr.c_str());
-    zobristHash ^= turnHash;
+    zobristHash = computeHash();
+    pawnHash = computePawnHash();
     halfMoveCount = fullMoveCount * 2;
 }
 
-uint64_t ChessBoard::getPiecesByColor(PieceType p, Color c) {
+uint64_t ChessBoard::getPiecesByColor(PieceType p, Color c) const {
     return pieceBitboards[int(p) + int(c) * colorIndexOffset];
 }
 
+int ChessBoard::castlingRights() const {
+    return int(whiteKingsideCastling) | int(whiteQueensideCastling) << 1
+         | int(blackKingsideCastling) << 2 | int(blackQueensideCastling) << 3;
+}
+
+// Hash of the position from scratch. executeMove keeps zobristHash equal to this
+// incrementally; the DEBUG_HASH build checks that after every make and undo.
+uint64_t ChessBoard::computeHash() const {
+    uint64_t hash = 0;
+    for (int p = wP; p <= bK; p++) {
+        uint64_t bb = pieceBitboards[p];
+        while (bb) {
+            hash ^= zobristTable[p][__builtin_ctzll(bb)];
+            bb &= bb - 1;
+        }
+    }
+    if (sideToMove == BLACK)
+        hash ^= turnHash;
+    hash ^= castlingHash[castlingRights()];
+    if (enPassantSquare != EMPTYSQ)
+        hash ^= enPassantHash[int(enPassantSquare) & 7];
+    return hash;
+}
+
+// Pawn-only part of the hash, used to key the pawn evaluation cache.
+uint64_t ChessBoard::computePawnHash() const {
+    uint64_t hash = 0;
+    for (int p : { wP, bP }) {
+        uint64_t bb = pieceBitboards[p];
+        while (bb) {
+            hash ^= zobristTable[p][__builtin_ctzll(bb)];
+            bb &= bb - 1;
+        }
+    }
+    return hash;
+}
+
+static inline bool isPawn(Piece p) {
+    return p == wP || p == bP;
+}
+
+// Running material and piece-square sums read by the evaluation; every mutator below
+// keeps them in step with the board.
+void ChessBoard::addPieceValue(Piece p, Square s) {
+    material += pieceMaterial[p];
+    psqScore[MIDDLEGAME] += pieceSquareValues[MIDDLEGAME][p][s];
+    psqScore[ENDGAME] += pieceSquareValues[ENDGAME][p][s];
+}
+
+void ChessBoard::subPieceValue(Piece p, Square s) {
+    material -= pieceMaterial[p];
+    psqScore[MIDDLEGAME] -= pieceSquareValues[MIDDLEGAME][p][s];
+    psqScore[ENDGAME] -= pieceSquareValues[ENDGAME][p][s];
+}
+
 void ChessBoard::placePiece(Piece p, Square s, Color c) {
     squareArray[s] = p;
     if (p != EMPTY) {
@@ -123,11 +194,13 @@ void ChessBoard::placePiece(Piece p, Square s, Color c) {
         occupiedBB |= sqBit;
         emptyBB &= ~sqBit;
         zobristHash ^= zobristTable[int(p)][s];
+        if (isPawn(p))
+            pawnHash ^= zobristTable[int(p)][s];
+        addPieceValue(p, s);
     } else {
         uint64_t sqBit = sToBB[s];
         emptyBB |= sqBit;
         occupiedBB &= ~sqBit;
-        zobristHash ^= zobristTable[int(p)][s];
     }
 }
 
@@ -141,7 +214,11 @@ void ChessBoard::movePieceTo(Piece p, Square fromSq, Square toSq, Color c) {
     emptyBB ^= deltaBit;
     squareArray[fromSq] = EMPTY;
     squareArray[toSq] = p;
-    zobristHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq] ^ zobristTable[int(EMPTY)][toSq] ^ zobristTable[int(EMPTY)][fromSq];
+    zobristHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq];
+    if (isPawn(p))
+        pawnHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq];
+    subPieceValue(p, fromSq);
+    addPieceValue(p, toSq);
 }
 
 void ChessBoard::capturePieceAt(Piece p, Piece capturedPiece, Square fromSq, Square toSq, Color c) {
@@ -156,7 +233,14 @@ void ChessBoard::capturePieceAt(Piece p, Piece capturedPiece, Square fromSq, Squ
     emptyBB ^= fromBit;
     squareArray[fromSq] = EMPTY;
     squareArray[toSq] = p;
-    zobristHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq] ^ zobristTable[int(capturedPiece)][toSq] ^ zobristTable[int(EMPTY)][fromSq];
+    zobristHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq] ^ zobristTable[int(capturedPiece)][toSq];
+    if (isPawn(p))
+        pawnHash ^= zobristTable[int(p)][fromSq] ^ zobristTable[int(p)][toSq];
+    if (isPawn(capturedPiece))
+        pawnHash ^= zobristTable[int(capturedPiece)][toSq];
+    subPieceValue(p, fromSq);
+    subPieceValue(capturedPiece, toSq);
+    addPieceValue(p, toSq);
 }
 
 void ChessBoard::promotePiece(Piece p, Piece newPiece, Square s) {
@@ -165,6 +249,10 @@ void ChessBoard::promotePiece(Piece p, Piece newPiece, Square s) {
     pieceBitboards[int(newPiece)] ^= sqBit;
     squareArray[s] = newPiece;
     zobristHash ^= zobristTable[int(p)][s] ^ zobristTable[int(newPiece)][s];
+    if (isPawn(p))
+        pawnHash ^= zobristTable[int(p)][s];
+    subPieceValue(p, s);
+    addPieceValue(newPiece, s);
 }
 
 void ChessBoard::removePieceFrom(Piece p, Square s, Color c) {
@@ -175,6 +263,9 @@ void ChessBoard::removePieceFrom(Piece p, Square s, Color c) {
     colorBitboards[c] ^= sqBit;
     squareArray[s] = EMPTY;
     zobristHash ^= zobristTable[int(p)][s];
+    if (isPawn(p))
+        pawnHash ^= zobristTable[int(p)][s];
+    subPieceValue(p, s);
 }
 
 void ChessBoard::executeMoveFromUCI(const std::string &uci) {
@@ -234,9 +325,13 @@ void ChessBoard::executeMove(Move moveData) {
     historyEntry.blackQueensideCastleStatus = blackQueensideCastling;
     historyEntry.enPassantStatus = enPassantSquare;
     historyEntry.prevHash = zobristHash;
+    historyEntry.prevPawnHash = pawnHash;
     historyEntry.whiteCastledBefore = whiteHasCastled;
     historyEntry.blackCastledBefore = blackHasCastled;
     moveHistory.push_back(historyEntry);
+    zobristHash ^= castlingHash[castlingRights()];
+    if (enPassantSquare != EMPTYSQ)
+        zobristHash ^= enPassantHash[int(enPassantSquare) & 7];
     if (!moveData.null) {
         switch (moveData.movetype) {
             case QUIET:
@@ -313,7 +408,17 @@ void ChessBoard::executeMove(Move moveData) {
     else
         enPassantSquare = EMPTYSQ;
     halfMoveCount++;
-    zobristHash ^= turnHash;
+    zobristHash ^= turnHash ^ castlingHash[castlingRights()];
+    if (enPassantSquare != EMPTYSQ)
+        zobristHash ^= enPassantHash[int(enPassantSquare) & 7];
+#ifdef DEBUG_HASH
+    assert(zobristHash == computeHash());
+    assert(pawnHash == computePawnHash());
+#endif
+}
+
+void ChessBoard::executeMove(PackedMove mv) {
+    executeMove(unpackMove(mv, this));
 }
 
 void ChessBoard::revertMoveNoUpdate(Move previousMove) {
@@ -416,11 +521,16 @@ void ChessBoard::revertLastMove() {
     blackQueensideCastling = lastEntry.blackQueensideCastleStatus;
     enPassantSquare = lastEntry.enPassantStatus;
     zobristHash = lastEntry.prevHash;
+    pawnHash = lastEntry.prevPawnHash;
     sideToMove = reverseColor(sideToMove);
     whiteHasCastled = lastEntry.whiteCastledBefore;
     blackHasCastled = lastEntry.blackCastledBefore;
     moveHistory.pop_back();
     halfMoveCount--;
+#ifdef DEBUG_HASH
+    assert(zobristHash == computeHash());
+    assert(pawnHash == computePawnHash());
+#endif
 }
 
 void ChessBoard::executeNullMove() {
@@ -9,6 +9,8 @@
 
 namespace Chess {
 
+struct PackedMove;
+
 struct MoveHistoryEntry {
     Move moveData;
     bool whiteKingsideCastleStatus;
@@ -17,6 +19,7 @@ struct MoveHistoryEntry {
     bool blackQueensideCastleStatus;
     Square enPassantStatus;
     uint64_t prevHash;
+    uint64_t prevPawnHash;
     bool whiteCastledBefore;
     bool blackCastledBefore;
 };
@@ -36,6 +39,9 @@ public:
     bool blackQueensideCastling;
     std::vector<MoveHistoryEntry> moveHistory;
     uint64_t zobristHash;
+    uint64_t pawnHash;
+    int material;
+    std::array<int, 2> psqScore;
     int halfMoveCount;
     int fullMoveCount;
     bool whiteHasCastled;
@@ -44,7 +50,12 @@ public:
     ChessBoard();
     void initializeStartingPosition();
     void initializeFEN(const std::string &fen);
-    uint64_t getPiecesByColor(PieceType p, Color c);
+    uint64_t getPiecesByColor(PieceType p, Color c) const;
+    int castlingRights() const;
+    uint64_t computeHash() const;
+    uint64_t computePawnHash() const;
+    void addPieceValue(Piece p, Square s);
+    void subPieceValue(Piece p, Square s);
     void placePiece(Piece p, Square s, Color c);
     void movePieceTo(Piece p, Square fromSq, Square toSq, Color c);
     void capturePieceAt(Piece p, Piece capturedPiece, Square fromSq, Square toSq, Color c);
@@ -53,6 +64,7 @@ public:
     void executeMoveFromUCI(const std::string &uci);
     void executeMoveNoUpdate(Move moveData);
     void executeMove(Move moveData);
+    void executeMove(PackedMove mv);
     void revertMoveNoUpdate(Move previousMove);
     void revertLastMove();
     void executeNullMove();
@@ -1,12 +1,14 @@
 #include "Constants.h"
 #include "Bitboard.h"
-#include <random>
 #include <algorithm>
 #include <functional>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace Chess {
 
-const std::array<u64, 8> files = {
+constexpr std::array<u64, 8> files = {
     0x101010101010101ULL,
     0x202020202020202ULL,
     0x404040404040404ULL,
@@ -17,12 +19,12 @@ const std::array<u64, 8> files = {
     0x8080808080808080ULL
 };
 
-const std::array<u64, 8> ranks = {
+constexpr std::array<u64, 8> ranks = {
     0xffULL, 0xff00ULL, 0xff0000ULL, 0xff000000ULL,
     0xff00000000ULL, 0xff0000000000ULL, 0xff000000000000ULL, 0xff00000000000000ULL
 };
 
-const std::array<u64, 15> diagonals = {
+constexpr std::array<u64, 15> diagonals = {
     0x80ULL, 0x8040ULL, 0x804020ULL,
     0x80402010ULL, 0x8040201008ULL, 0x804020100804ULL,
     0x80402010080402ULL, 0x8040201008040201ULL, 0x4020100804020100ULL,
@@ -30,7 +32,7 @@ const std::array<u64, 15> diagonals = {
     0x402010000000000ULL, 0x201000000000000ULL, 0x100000000000000ULL
 };
 
-const std::array<u64, 15> antiDiagonals = {
+constexpr std::array<u64, 15> antiDiagonals = {
     0x1ULL, 0x102ULL, 0x10204ULL,
     0x1020408ULL, 0x102040810ULL, 0x10204081020ULL,
     0x1020408102040ULL, 0x102040810204080ULL, 0x204081020408000ULL,
@@ -38,13 +40,13 @@ const std::array<u64, 15> antiDiagonals = {
     0x2040800000000000ULL, 0x4080000000000000ULL, 0x8000000000000000ULL
 };
 
-const u64 a1h8Diagonal = 0x8040201008040201ULL;
-const u64 h1a8Diagonal = 0x0102040810204080ULL;
-const u64 lightSquares = 0x55AA55AA55AA55AAULL;
-const u64 darkSquares = 0xAA55AA55AA55AA55ULL;
+constexpr u64 a1h8Diagonal = 0x8040201008040201ULL;
+constexpr u64 h1a8Diagonal = 0x0102040810204080ULL;
+constexpr u64 lightSquares = 0x55AA55AA55AA55AAULL;
+constexpr u64 darkSquares = 0xAA55AA55AA55AA55ULL;
 
-const u64 queenside = 0xf0f0f0f0f0f0f0fULL;
-const u64 kingside  = 0xf0f0f0f0f0f0f0f0ULL;
+constexpr u64 queenside = 0xf0f0f0f0f0f0f0fULL;
+constexpr u64 kingside  = 0xf0f0f0f0f0f0f0f0ULL;
 
 Color reverseColor(Color c) {
     return static_cast<Color>(c ^ 1);
@@ -86,18 +88,21 @@ Piece getCP(Color c, PieceType pt) {
     return static_cast<Piece>(static_cast<int>(pt) + colorIndexOffset * static_cast<int>(c));
 }
 
-std::array<u64, 8> fileNeighbors;
-void initNeighborMasks() {
+static constexpr std::array<u64, 8> makeFileNeighbors() {
+    std::array<u64, 8> table{};
     for (int f = A; f <= H; f++) {
         if (f == A)
-            fileNeighbors[f] = files[B];
+            table[f] = files[B];
         else if (f == H)
-            fileNeighbors[f] = files[G];
+            table[f] = files[G];
         else
-            fileNeighbors[f] = files[f - 1] | files[f + 1];
+            table[f] = files[f - 1] | files[f + 1];
     }
+    return table;
 }
 
+constexpr std::array<u64, 8> fileNeighbors = makeFileNeighbors();
+
 const std::vector<Rank> almostPromotion = { R7, R2 };
 const std::vector<Rank> startingRank = { R2, R7 };
 const std::vector<Direction> pawnPushDirection = { NORTH, SOUTH };
@@ -143,23 +148,45 @@ Square goDirection(Square s, Direction d) {
     return static_cast<Square>(static_cast<int>(s) + static_cast<int>(d));
 }
 
-std::array<u64, 64> kingAttacksSquareLookup;
-void initializeKingAttacks() {
-    u64 bb = 1;
+// All attack, geometry and hashing tables below are computed by the compiler and land
+// in read-only data, so nothing has to be initialized at startup and every engine
+// process maps the same pages. Constants.cpp needs a raised constexpr evaluation limit
+// for the slider tables (see CMakeLists.txt).
+
+static constexpr int popCountConst(u64 b) {
+    int n = 0;
+    while (b) {
+        b &= b - 1;
+        n++;
+    }
+    return n;
+}
+
+static constexpr u64 shiftConst(u64 b, int d) {
+    u64 shifted = d > 0 ? b << d : b >> -d;
+    if (d == NE || d == EAST || d == SE)
+        return shifted & ~files[A];
+    if (d == NW || d == WEST || d == SW)
+        return shifted & ~files[H];
+    return shifted;
+}
+
+static constexpr std::array<u64, 64> makeKingAttacks() {
+    std::array<u64, 64> table{};
     for (int i = 0; i < 64; i++) {
-        u64 copy = bb;
-        u64 atk = shiftBitboard(copy, EAST) | shiftBitboard(copy, WEST);
-        copy |= atk;
-        atk |= shiftBitboard(copy, NORTH) | shiftBitboard(copy, SOUTH);
-        kingAttacksSquareLookup[i] = atk;
-        bb <<= 1;
+        u64 bb = 1ULL << i;
+        u64 atk = shiftConst(bb, EAST) | shiftConst(bb, WEST);
+        bb |= atk;
+        atk |= shiftConst(bb, NORTH) | shiftConst(bb, SOUTH);
+        table[i] = atk;
     }
+    return table;
 }
 
-std::array<u64, 64> knightAttacksSquareLookup;
-void initializeKnightAttacks() {
-    u64 bb = 1;
+static constexpr std::array<u64, 64> makeKnightAttacks() {
+    std::array<u64, 64> table{};
     for (int i = 0; i < 64; i++) {
+        u64 bb = 1ULL << i;
         u64 atk = 0;
         atk |= (bb << 17) & ~files[A];
         atk |= (bb << 10) & ~files[A] & ~files[B];
@@ -169,59 +196,77 @@ void initializeKnightAttacks() {
         atk |= (bb << 6)  & ~files[G] & ~files[H];
         atk |= (bb >> 10) & ~files[G] & ~files[H];
         atk |= (bb >> 17) & ~files[H];
-        knightAttacksSquareLookup[i] = atk;
-        bb <<= 1;
+        table[i] = atk;
     }
+    return table;
 }
 
-std::array<u64, 64> whitePawnAttacksSquareLookup;
-std::array<u64, 64> blackPawnAttacksSquareLookup;
-void initializePawnAttacks() {
-    u64 bb = 1;
+static constexpr std::array<u64, 64> makePawnAttacks(Color c) {
+    std::array<u64, 64> table{};
     for (int i = 0; i < 64; i++) {
-        u64 atk = shiftBitboard(bb, NE) | shiftBitboard(bb, NW);
-        whitePawnAttacksSquareLookup[i] = atk;
-        atk = shiftBitboard(bb, SE) | shiftBitboard(bb, SW);
-        blackPawnAttacksSquareLookup[i] = atk;
-        bb <<= 1;
+        u64 bb = 1ULL << i;
+        table[i] = c == WHITE ? shiftConst(bb, NE) | shiftConst(bb, NW) : shiftConst(bb, SE) | shiftConst(bb, SW);
     }
+    return table;
 }
 
-std::array<const u64*, 2> colorToPawnLookup = { &whitePawnAttacksSquareLookup, &blackPawnAttacksSquareLookup };
-std::array<const u64*, 2> colorToPawnLookupReverse = { &blackPawnAttacksSquareLookup, &whitePawnAttacksSquareLookup };
+constexpr std::array<u64, 64> kingAttacksSquareLookup = makeKingAttacks();
+constexpr std::array<u64, 64> knightAttacksSquareLookup = makeKnightAttacks();
+constexpr std::array<u64, 64> whitePawnAttacksSquareLookup = makePawnAttacks(WHITE);
+constexpr std::array<u64, 64> blackPawnAttacksSquareLookup = makePawnAttacks(BLACK);
 
-std::vector<Piece> colorToKingLookup = { wK, bK };
+const std::array<const u64*, 2> colorToPawnLookup = { whitePawnAttacksSquareLookup.data(), blackPawnAttacksSquareLookup.data() };
+const std::array<const u64*, 2> colorToPawnLookupReverse = { blackPawnAttacksSquareLookup.data(), whitePawnAttacksSquareLookup.data() };
 
-std::array<u64, 64> sToBB;
-void initializeSQLookup() {
-    for (int i = 0; i < 64; i++) {
-        sToBB[i] = 1ULL << i;
-    }
+const std::vector<Piece> colorToKingLookup = { wK, bK };
+
+static constexpr std::array<u64, 64> makeSquareBitboards() {
+    std::array<u64, 64> table{};
+    for (int i = 0; i < 64; i++)
+        table[i] = 1ULL << i;
+    return table;
 }
 
-u64 slidingAttacks(Square s, u64 b, u64 locs) {
-    u64 a = (locs & b) - (sToBB[s] << 1);
-    auto reverseBits = [](u64 val) -> u64 {
-        u64 rev = 0;
-        for (int i = 0; i < 64; i++) {
-            rev <<= 1;
-            rev |= (val & 1);
-            val >>= 1;
-        }
-        return rev;
+constexpr std::array<u64, 64> sToBB = makeSquareBitboards();
+
+// Ray-walks from s in the four rook or bishop directions, stopping on (and including)
+// the first occupied square.
+static constexpr u64 slidingAttacksConst(int s, u64 occ, bool isBishop) {
+    constexpr int deltas[2][4][2] = {
+        { {1, 0}, {-1, 0}, {0, 1}, {0, -1} },
+        { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} }
     };
-    u64 c = reverseBits(b & locs) - (reverseBits(sToBB[s]) << 1);
-    u64 d = reverseBits(c);
-    return (a ^ d) & locs;
+    u64 atk = 0;
+    for (int k = 0; k < 4; k++) {
+        int f = (s & 7) + deltas[isBishop][k][0];
+        int r = (s >> 3) + deltas[isBishop][k][1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8) {
+            u64 bb = 1ULL << (r * 8 + f);
+            atk |= bb;
+            if (occ & bb)
+                break;
+            f += deltas[isBishop][k][0];
+            r += deltas[isBishop][k][1];
+        }
+    }
+    return atk;
 }
 
-std::array<u64, 64> bishopMasks;
-std::array<u64, 64> rookMasks;
+static constexpr u64 sliderMask(int s, bool isBishop) {
+    u64 edgeMask = (files[A] | files[H]) & ~files[s & 7];
+    edgeMask |= (ranks[R1] | ranks[R8]) & ~ranks[s >> 3];
+    return slidingAttacksConst(s, 0, isBishop) & ~edgeMask;
+}
+
+u64 slidingBishopAttacksForInitialization(Square s, u64 b) {
+    return slidingAttacksConst(s, b, true);
+}
 
-std::array<std::array<u64, 512>, 64> bishopAttacks;
-std::array<std::array<u64, 4096>, 64> rookAttacks;
+u64 slidingRookAttacksForInitialization(Square s, u64 b) {
+    return slidingAttacksConst(s, b, false);
+}
 
-std::array<u64, 64> rookMagics = {
+constexpr std::array<u64, 64> rookMagics = {
     0xa8002c000108020ULL, 0x6c00049b0002001ULL, 0x100200010090040ULL, 0x2480041000800801ULL,
     0x280028004000800ULL, 0x900410008040022ULL, 0x280020001001080ULL, 0x2880002041000080ULL,
     0xa000800080400034ULL, 0x4808020004000ULL, 0x2290802004801000ULL, 0x411000d00100020ULL,
@@ -240,7 +285,7 @@ std::array<u64, 64> rookMagics = {
     0x489a000810200402ULL, 0x1004400080a13ULL, 0x4000011008020084ULL, 0x26002114058042ULL,
 };
 
-std::array<u64, 64> bishopMagics = {
+constexpr std::array<u64, 64> bishopMagics = {
     0x89a1121896040240ULL, 0x2004844802002010ULL, 0x2068080051921000ULL, 0x62880a0220200808ULL,
     0x4042004000000ULL, 0x100822020200011ULL, 0xc00444222012000aULL, 0x28808801216001ULL,
     0x400492088408100ULL, 0x201c401040c0084ULL, 0x840800910a0010ULL, 0x82080240060ULL,
@@ -259,103 +304,187 @@ std::array<u64, 64> bishopMagics = {
     0x1000042304105ULL, 0x10008830412a00ULL, 0x2520081090008908ULL, 0x40102000a0a60140ULL,
 };
 
-std::array<int, 64> rookShifts;
-std::array<int, 64> bishopShifts;
-
-u64 slidingBishopAttacksForInitialization(Square s, u64 b) {
-    u64 atk = 0;
-    atk |= slidingAttacks(s, b, sqToAntiDiag(s));
-    atk |= slidingAttacks(s, b, sqToDiag(s));
-    return atk;
-}
+template<size_t N>
+struct SliderTables {
+    std::array<u64, N> magicAttacks{};
+    std::array<u64, N> pextAttacks{};
+    std::array<u64, 64> masks{};
+    std::array<int, 64> shifts{};
+    std::array<int, 64> offsets{};
+};
 
-void initBishopAttacks() {
+// Fills the offset-based magic table and the dense PEXT table in one pass. The
+// carry-rippler walks each mask's subsets in increasing order, which is exactly their
+// PEXT order, so the n-th subset lands in dense slot n.
+template<size_t N>
+static constexpr SliderTables<N> makeSliderTables(bool isBishop, const std::array<u64, 64>& magics) {
+    SliderTables<N> t{};
+    int offset = 0;
     for (int s = a1; s <= h8; s++) {
-        u64 edgeMask = (files[A] | files[H]) & ~files[sqToFile(static_cast<Square>(s))];
-        edgeMask |= (ranks[R1] | ranks[R8]) & ~ranks[sqToRank(static_cast<Square>(s))];
-        bishopMasks[s] = (sqToAntiDiag(static_cast<Square>(s)) ^ sqToDiag(static_cast<Square>(s))) & ~edgeMask;
-        bishopShifts[s] = 64 - popCount(bishopMasks[s]);
+        u64 mask = sliderMask(s, isBishop);
+        t.masks[s] = mask;
+        t.shifts[s] = 64 - popCountConst(mask);
+        t.offsets[s] = offset;
         u64 i = 0;
-        while (true) {
-            u64 j = i;
-            j *= bishopMagics[s];
-            j >>= bishopShifts[s];
-            bishopAttacks[s][j] = slidingBishopAttacksForInitialization(static_cast<Square>(s), i);
-            i = (i - bishopMasks[s]) & bishopMasks[s];
-            if (i == 0)
-                break;
-        }
+        int n = 0;
+        do {
+            u64 atk = slidingAttacksConst(s, i, isBishop);
+            u64& slot = t.magicAttacks[offset + ((i * magics[s]) >> t.shifts[s])];
+            // A slider always attacks something, so a filled slot is never zero. Two
+            // occupancies with different attacks sharing a slot means a bad magic; the
+            // throw makes the constant evaluation, and so the build, fail.
+            if (slot != 0 && slot != atk)
+                throw "destructive magic collision";
+            slot = atk;
+            t.pextAttacks[offset + n++] = atk;
+            i = (i - mask) & mask;
+        } while (i);
+        offset += n;
     }
+    return t;
 }
 
-u64 slidingRookAttacksForInitialization(Square s, u64 b) {
-    u64 atk = 0;
-    atk |= slidingAttacks(s, b, files[sqToFile(static_cast<Square>(s))]);
-    atk |= slidingAttacks(s, b, ranks[sqToRank(static_cast<Square>(s))]);
-    return atk;
+static constexpr SliderTables<5248> BISHOP_TABLES = makeSliderTables<5248>(true, bishopMagics);
+static constexpr SliderTables<102400> ROOK_TABLES = makeSliderTables<102400>(false, rookMagics);
+
+constexpr std::array<u64, 64> bishopMasks = BISHOP_TABLES.masks;
+constexpr std::array<u64, 64> rookMasks = ROOK_TABLES.masks;
+constexpr std::array<int, 64> bishopShifts = BISHOP_TABLES.shifts;
+constexpr std::array<int, 64> rookShifts = ROOK_TABLES.shifts;
+constexpr std::array<int, 64> bishopOffsets = BISHOP_TABLES.offsets;
+constexpr std::array<int, 64> rookOffsets = ROOK_TABLES.offsets;
+constexpr std::array<u64, 5248> bishopAttacks = BISHOP_TABLES.magicAttacks;
+constexpr std::array<u64, 102400> rookAttacks = ROOK_TABLES.magicAttacks;
+constexpr std::array<u64, 5248> bishopPextAttacks = BISHOP_TABLES.pextAttacks;
+constexpr std::array<u64, 102400> rookPextAttacks = ROOK_TABLES.pextAttacks;
+
+SliderBackend sliderBackend = MAGIC_BACKEND;
+
+bool cpuHasBmi2() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
 }
 
-void initRookAttacks() {
-    for (int s = a1; s <= h8; s++) {
-        u64 edgeMask = (files[A] | files[H]) & ~files[sqToFile(static_cast<Square>(s))];
-        edgeMask |= (ranks[R1] | ranks[R8]) & ~ranks[sqToRank(static_cast<Square>(s))];
-        rookMasks[s] = (files[sqToFile(static_cast<Square>(s))] ^ ranks[sqToRank(static_cast<Square>(s))]) & ~edgeMask;
-        rookShifts[s] = 64 - popCount(rookMasks[s]);
-        u64 i = 0;
-        while (true) {
-            u64 j = i;
-            j *= rookMagics[s];
-            j >>= rookShifts[s];
-            rookAttacks[s][j] = slidingRookAttacksForInitialization(static_cast<Square>(s), i);
-            i = (i - rookMasks[s]) & rookMasks[s];
-            if (i == 0)
-                break;
-        }
+void initSliderBackend() {
+    sliderBackend = cpuHasBmi2() ? PEXT_BACKEND : MAGIC_BACKEND;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+// Compiled for BMI2 without requiring it for the whole binary; only ever called once
+// initSliderBackend has seen the instruction set on this host.
+__attribute__((target("bmi2"))) u64 pextBishopAttacks(Square s, u64 occ) {
+    return bishopPextAttacks[bishopOffsets[s] + _pext_u64(occ, bishopMasks[s])];
+}
+
+__attribute__((target("bmi2"))) u64 pextRookAttacks(Square s, u64 occ) {
+    return rookPextAttacks[rookOffsets[s] + _pext_u64(occ, rookMasks[s])];
+}
+#else
+static u64 softwarePext(u64 occ, u64 mask) {
+    u64 result = 0;
+    for (u64 bit = 1; mask; bit <<= 1) {
+        if (occ & mask & -mask)
+            result |= bit;
+        mask &= mask - 1;
     }
+    return result;
+}
+
+u64 pextBishopAttacks(Square s, u64 occ) {
+    return bishopPextAttacks[bishopOffsets[s] + softwarePext(occ, bishopMasks[s])];
+}
+
+u64 pextRookAttacks(Square s, u64 occ) {
+    return rookPextAttacks[rookOffsets[s] + softwarePext(occ, rookMasks[s])];
+}
+#endif
+
+static constexpr bool sameLine(int i, int j, bool isBishop) {
+    if (!isBishop)
+        return (i & 7) == (j & 7) || (i >> 3) == (j >> 3);
+    return (i >> 3) - (i & 7) == (j >> 3) - (j & 7) || (i >> 3) + (i & 7) == (j >> 3) + (j & 7);
 }
 
-std::array<std::array<u64, 64>, 64> squaresBetween;
-void initSquaresBetween() {
-    u64 sq;
+static constexpr std::array<std::array<u64, 64>, 64> makeSquaresBetween() {
+    std::array<std::array<u64, 64>, 64> table{};
     for (int i = a1; i <= h8; i++) {
         for (int j = a1; j <= h8; j++) {
-            sq = (1ULL << i) | (1ULL << j);
-            if (sqToFile(static_cast<Square>(i)) == sqToFile(static_cast<Square>(j)) ||
-                sqToRank(static_cast<Square>(i)) == sqToRank(static_cast<Square>(j)))
-                squaresBetween[i][j] = slidingRookAttacksForInitialization(static_cast<Square>(i), sq) & slidingRookAttacksForInitialization(static_cast<Square>(j), sq);
-            else if (sqToDiag(static_cast<Square>(i)) == sqToDiag(static_cast<Square>(j)) ||
-                     sqToAntiDiag(static_cast<Square>(i)) == sqToAntiDiag(static_cast<Square>(j)))
-                squaresBetween[i][j] = slidingBishopAttacksForInitialization(static_cast<Square>(i), sq) & slidingBishopAttacksForInitialization(static_cast<Square>(j), sq);
+            u64 sq = (1ULL << i) | (1ULL << j);
+            if (sameLine(i, j, false))
+                table[i][j] = slidingAttacksConst(i, sq, false) & slidingAttacksConst(j, sq, false);
+            else if (sameLine(i, j, true))
+                table[i][j] = slidingAttacksConst(i, sq, true) & slidingAttacksConst(j, sq, true);
         }
     }
+    return table;
 }
 
-std::array<std::array<u64, 64>, 64> line;
-void initLine() {
+static constexpr std::array<std::array<u64, 64>, 64> makeLine() {
+    std::array<std::array<u64, 64>, 64> table{};
     for (int i = a1; i <= h8; i++) {
         for (int j = a1; j <= h8; j++) {
-            if (sqToFile(static_cast<Square>(i)) == sqToFile(static_cast<Square>(j)) ||
-                sqToRank(static_cast<Square>(i)) == sqToRank(static_cast<Square>(j)))
-                line[i][j] = (slidingRookAttacksForInitialization(static_cast<Square>(i), 0) & slidingRookAttacksForInitialization(static_cast<Square>(j), 0)) | (1ULL << i) | (1ULL << j);
-            else if (sqToDiag(static_cast<Square>(i)) == sqToDiag(static_cast<Square>(j)) ||
-                     sqToAntiDiag(static_cast<Square>(i)) == sqToAntiDiag(static_cast<Square>(j)))
-                line[i][j] = (slidingBishopAttacksForInitialization(static_cast<Square>(i), 0) & slidingBishopAttacksForInitialization(static_cast<Square>(j), 0)) | (1ULL << i) | (1ULL << j);
+            if (sameLine(i, j, false))
+                table[i][j] = (slidingAttacksConst(i, 0, false) & slidingAttacksConst(j, 0, false)) | (1ULL << i) | (1ULL << j);
+            else if (sameLine(i, j, true))
+                table[i][j] = (slidingAttacksConst(i, 0, true) & slidingAttacksConst(j, 0, true)) | (1ULL << i) | (1ULL << j);
         }
     }
+    return table;
 }
 
-std::array<std::array<u64, 64>, 13> zobristTable;
-u64 turnHash;
-void initZobrist() {
-    std::mt19937_64 rng(42);
+constexpr std::array<std::array<u64, 64>, 64> squaresBetween = makeSquaresBetween();
+constexpr std::array<std::array<u64, 64>, 64> line = makeLine();
+
+// SplitMix64 stands in for the old runtime std::mt19937_64 so the keys can be produced
+// at compile time; they are fixed by the seed just as before.
+static constexpr u64 splitMix64(u64& state) {
+    u64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct ZobristKeys {
+    std::array<std::array<u64, 64>, 13> table{};
+    u64 turn = 0;
+    std::array<u64, 16> castling{};
+    std::array<u64, 8> enPassant{};
+};
+
+static constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    u64 state = 42;
     for (int i = 0; i < 13; i++) {
-        for (int j = 0; j < 64; j++) {
-            zobristTable[i][j] = rng();
+        for (int j = 0; j < 64; j++)
+            keys.table[i][j] = splitMix64(state);
+    }
+    keys.turn = splitMix64(state);
+    // One key per right; a rights mask hashes as the XOR of its rights, so clearing a
+    // single right is a single XOR pair in the incremental update as well.
+    std::array<u64, 4> rights{};
+    for (u64& key : rights)
+        key = splitMix64(state);
+    for (int mask = 0; mask < 16; mask++) {
+        for (int r = 0; r < 4; r++) {
+            if (mask & (1 << r))
+                keys.castling[mask] ^= rights[r];
         }
     }
-    turnHash = rng();
+    for (u64& key : keys.enPassant)
+        key = splitMix64(state);
+    return keys;
 }
 
+static constexpr ZobristKeys ZOBRIST_KEYS = makeZobristKeys();
+constexpr std::array<std::array<u64, 64>, 13> zobristTable = ZOBRIST_KEYS.table;
+constexpr u64 turnHash = ZOBRIST_KEYS.turn;
+constexpr std::array<u64, 16> castlingHash = ZOBRIST_KEYS.castling;
+constexpr std::array<u64, 8> enPassantHash = ZOBRIST_KEYS.enPassant;
+
 template<typename T>
 bool contains(const std::vector<T>& vec, const T& element) {
     for (const auto& a : vec) {
@@ -46,8 +46,7 @@ enum Direction { NORTH = 8, NW = 7, NE = 9, WEST = -1, EAST = 1, SW = -9, SOUTH
 
 // File and Rank
 enum File { A, B, C, D, E, F, G, H };
-extern std::array<u64, 8> fileNeighbors;
-void initNeighborMasks();
+extern const std::array<u64, 8> fileNeighbors;
 
 enum Rank { R1, R2, R3, R4, R5, R6, R7, R8 };
 extern const std::vector<Rank> almostPromotion; // [WHITE] = R7, [BLACK] = R2
@@ -75,45 +74,53 @@ u64 sqToDiag(Square s);
 u64 sqToAntiDiag(Square s);
 Square goDirection(Square s, Direction d);
 
-// Lookup tables and initialization functions
-extern std::array<u64, 64> kingAttacksSquareLookup;
-void initializeKingAttacks();
-extern std::array<u64, 64> knightAttacksSquareLookup;
-void initializeKnightAttacks();
-extern std::array<u64, 64> whitePawnAttacksSquareLookup;
-extern std::array<u64, 64> blackPawnAttacksSquareLookup;
-void initializePawnAttacks();
-extern std::array<const u64*, 2> colorToPawnLookup;
-extern std::array<const u64*, 2> colorToPawnLookupReverse;
+// Lookup tables, all generated at compile time in Constants.cpp
+extern const std::array<u64, 64> kingAttacksSquareLookup;
+extern const std::array<u64, 64> knightAttacksSquareLookup;
+extern const std::array<u64, 64> whitePawnAttacksSquareLookup;
+extern const std::array<u64, 64> blackPawnAttacksSquareLookup;
+extern const std::array<const u64*, 2> colorToPawnLookup;
+extern const std::array<const u64*, 2> colorToPawnLookupReverse;
 extern const std::vector<Piece> colorToKingLookup;
-extern std::array<u64, 64> sToBB;
-void initializeSQLookup();
+extern const std::array<u64, 64> sToBB;
 
 // Magic bitboard functions and lookup tables
-u64 slidingAttacks(Square s, u64 b, u64 locs);
-extern std::array<u64, 64> bishopMasks;
-extern std::array<u64, 64> rookMasks;
-extern std::array<std::array<u64, 512>, 64> bishopAttacks;
-extern std::array<std::array<u64, 4096>, 64> rookAttacks;
-extern std::array<u64, 64> rookMagics;
-extern std::array<u64, 64> bishopMagics;
-extern std::array<int, 64> rookShifts;
-extern std::array<int, 64> bishopShifts;
+extern const std::array<u64, 64> bishopMasks;
+extern const std::array<u64, 64> rookMasks;
+// "Fancy" magic layout: each square owns exactly 2^popcount(mask) slots starting at its
+// offset in one shared table, instead of a fixed 512/4096 rows per square.
+extern const std::array<u64, 5248> bishopAttacks;
+extern const std::array<u64, 102400> rookAttacks;
+extern const std::array<int, 64> bishopOffsets;
+extern const std::array<int, 64> rookOffsets;
+extern const std::array<u64, 64> rookMagics;
+extern const std::array<u64, 64> bishopMagics;
+extern const std::array<int, 64> rookShifts;
+extern const std::array<int, 64> bishopShifts;
 u64 slidingBishopAttacksForInitialization(Square s, u64 b);
-void initBishopAttacks();
 u64 slidingRookAttacksForInitialization(Square s, u64 b);
-void initRookAttacks();
+
+// PEXT slider backend: dense per-square tables indexed by the occupancy bits extracted
+// under each mask, sharing the magic offsets. Selected at startup by CPUID.
+enum SliderBackend { MAGIC_BACKEND, PEXT_BACKEND };
+extern SliderBackend sliderBackend;
+extern const std::array<u64, 5248> bishopPextAttacks;
+extern const std::array<u64, 102400> rookPextAttacks;
+bool cpuHasBmi2();
+void initSliderBackend();
+u64 pextBishopAttacks(Square s, u64 occ);
+u64 pextRookAttacks(Square s, u64 occ);
 
 // Other lookup tables
-extern std::array<std::array<u64, 64>, 64> squaresBetween;
-void initSquaresBetween();
-extern std::array<std::array<u64, 64>, 64> line;
-void initLine();
-
-// Zobrist keys
-extern std::array<std::array<u64, 64>, 13> zobristTable;
-extern u64 turnHash;
-void initZobrist();
+extern const std::array<std::array<u64, 64>, 64> squaresBetween;
+extern const std::array<std::array<u64, 64>, 64> line;
+
+// Zobrist keys. castlingHash is indexed by the 4-bit rights mask (white kingside = 1,
+// white queenside = 2, black kingside = 4, black queenside = 8), enPassantHash by file.
+extern const std::array<std::array<u64, 64>, 13> zobristTable;
+extern const u64 turnHash;
+extern const std::array<u64, 16> castlingHash;
+extern const std::array<u64, 8> enPassantHash;
 
 // Helper template functions for testing
 template<typename T>
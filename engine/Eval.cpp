@@ -53,21 +53,11 @@ static const int PIECES_ON_BACK_RANK = -15;
 
 static const std::array<int, 2> FACTOR = { 1, -1 };
 
-static const std::map<Piece, int> MATERIAL = {
-    { wP, PAWN_VALUE }, { bP, -PAWN_VALUE },
-    { wN, KNIGHT_VALUE }, { bN, -KNIGHT_VALUE },
-    { wB, BISHOP_VALUE }, { bB, -BISHOP_VALUE },
-    { wR, ROOK_VALUE }, { bR, -ROOK_VALUE },
-    { wQ, QUEEN_VALUE }, { bQ, -QUEEN_VALUE },
-    { wK, KING_VALUE }, { bK, -KING_VALUE },
-    { EMPTY, 0 }
-};
-
 static const std::map<Square, bool> CENTER = {
     { e4, true }, { d4, true }, { e5, true }, { d5, true }
 };
 
-static const std::array<int, 64> REVERSE_PSQ = {
+static constexpr std::array<int, 64> REVERSE_PSQ = {
     56,57,58,59,60,61,62,63,
     48,49,50,51,52,53,54,55,
     40,41,42,43,44,45,46,47,
@@ -78,7 +68,7 @@ static const std::array<int, 64> REVERSE_PSQ = {
     0,1,2,3,4,5,6,7
 };
 
-static const std::array<int, 64> PAWN_SQUARE_TABLE = {
+static constexpr std::array<int, 64> PAWN_SQUARE_TABLE = {
     0,0,0,0,0,0,0,0,
     5,10,-10,-20,-20,10,10,5,
     5,5,5,0,0,-10,5,5,
@@ -89,7 +79,7 @@ static const std::array<int, 64> PAWN_SQUARE_TABLE = {
     0,0,0,0,0,0,0,0
 };
 
-static const std::array<int, 64> KNIGHT_SQUARE_TABLE = {
+static constexpr std::array<int, 64> KNIGHT_SQUARE_TABLE = {
     -50,-30,-30,-30,-30,-30,-30,-50,
     -40,-20,0,-5,-5,0,-20,-40,
     -40,0,10,15,15,10,0,-40,
@@ -100,7 +90,7 @@ static const std::array<int, 64> KNIGHT_SQUARE_TABLE = {
     -50,-40,-30,-30,-30,-30,-40,-50
 };
 
-static const std::array<int, 64> BISHOP_SQUARE_TABLE = {
+static constexpr std::array<int, 64> BISHOP_SQUARE_TABLE = {
     -20,-10,-5,-10,-10,-10,-10,-20,
     -10,10,0,0,0,0,10,-10,
     -10,10,10,10,10,10,10,-10,
@@ -111,7 +101,7 @@ static const std::array<int, 64> BISHOP_SQUARE_TABLE = {
     -20,-10,-10,-10,-10,-10,-10,-20
 };
 
-static const std::array<int, 64> ROOK_SQUARE_TABLE = {
+static constexpr std::array<int, 64> ROOK_SQUARE_TABLE = {
     -5,0,0,5,5,0,0,-5,
     -5,0,0,0,0,0,0,-5,
     -5,0,0,0,0,0,0,-5,
@@ -122,7 +112,7 @@ static const std::array<int, 64> ROOK_SQUARE_TABLE = {
     0,0,0,0,0,0,0,0
 };
 
-static const std::array<int, 64> QUEEN_SQUARE_TABLE = {
+static constexpr std::array<int, 64> QUEEN_SQUARE_TABLE = {
     -20,-10,-10,5,-5,-10,-10,-20,
     -10,0,0,0,0,0,0,-10,
     -10,-5,-5,-5,-5,-5,0,-10,
@@ -133,7 +123,7 @@ static const std::array<int, 64> QUEEN_SQUARE_TABLE = {
     -20,-10,-10,-5,-5,-10,-10,-20
 };
 
-static const std::array<int, 64> KING_SQUARE_TABLE_MIDDLEGAME = {
+static constexpr std::array<int, 64> KING_SQUARE_TABLE_MIDDLEGAME = {
     0,30,10,0,0,10,30,0,
     -30,-30,-30,-30,-30,-30,-30,-30,
     -50,-50,-50,-50,-50,-50,-50,-50,
@@ -144,7 +134,7 @@ static const std::array<int, 64> KING_SQUARE_TABLE_MIDDLEGAME = {
     -70,-70,-70,-70,-70,-70,-70,-70
 };
 
-static const std::array<int, 64> KING_SQUARE_TABLE_ENDGAME = {
+static constexpr std::array<int, 64> KING_SQUARE_TABLE_ENDGAME = {
     -50,-10,0,0,0,0,-10,-50,
     -10,0,10,10,10,10,0,-10,
     0,10,15,15,15,15,10,0,
@@ -155,14 +145,41 @@ static const std::array<int, 64> KING_SQUARE_TABLE_ENDGAME = {
     -50,-10,0,0,0,0,-10,-50
 };
 
-int evaluatePosition(ChessBoard* board) {
-    auto legalMoves = board->generateLegalMoves();
-    if (legalMoves.empty()) {
-        if (board->isCheck(board->sideToMove))
-            return WIN_VALUE * FACTOR[reverseColor(board->sideToMove)];
-        else
-            return 0;
+constexpr std::array<int, 13> pieceMaterial = {
+    PAWN_VALUE, BISHOP_VALUE, KNIGHT_VALUE, ROOK_VALUE, QUEEN_VALUE, KING_VALUE,
+    -PAWN_VALUE, -BISHOP_VALUE, -KNIGHT_VALUE, -ROOK_VALUE, -QUEEN_VALUE, -KING_VALUE,
+    0
+};
+
+static constexpr std::array<std::array<std::array<int, 64>, 13>, 2> makePieceSquareValues() {
+    std::array<std::array<std::array<int, 64>, 13>, 2> values{};
+    for (int phase = MIDDLEGAME; phase <= ENDGAME; phase++) {
+        const std::array<int, 64>* tables[6] = {
+            &PAWN_SQUARE_TABLE, &BISHOP_SQUARE_TABLE, &KNIGHT_SQUARE_TABLE, &ROOK_SQUARE_TABLE, &QUEEN_SQUARE_TABLE,
+            phase == MIDDLEGAME ? &KING_SQUARE_TABLE_MIDDLEGAME : &KING_SQUARE_TABLE_ENDGAME
+        };
+        for (int pt = 0; pt < 6; pt++) {
+            for (int sq = 0; sq < 64; sq++) {
+                values[phase][pt][sq] = (*tables[pt])[sq];
+                values[phase][pt + colorIndexOffset][sq] = -(*tables[pt])[REVERSE_PSQ[sq]];
+            }
+        }
     }
+    return values;
+}
+
+constexpr std::array<std::array<std::array<int, 64>, 13>, 2> pieceSquareValues = makePieceSquareValues();
+
+// Power of two so the pawn key can be masked into an index.
+static const size_t PAWN_TABLE_SIZE = 1 << 14;
+// One pawn table per search thread: it is small, and private tables need no locking.
+static thread_local std::vector<PawnEntry> pawnTable(PAWN_TABLE_SIZE);
+static thread_local uint64_t pawnTableProbes = 0;
+static thread_local uint64_t pawnTableHits = 0;
+
+// Static evaluation from white's point of view. It never generates moves: mate and
+// stalemate are recognised by the search, which already has the move list.
+int evaluatePosition(ChessBoard* board) {
     if (board->isThreeFoldRep())
         return 0;
     if (board->isInsufficientMaterial())
@@ -207,17 +224,12 @@ int evaluatePosition(ChessBoard* board) {
 }
 
 std::pair<int, int> totalMaterialAndPieces(ChessBoard* board) {
-    int sum = 0;
-    int total = 0;
-    for (auto piece : board->squareArray) {
-        sum += MATERIAL.at(piece);
-        if (piece != EMPTY)
-            total++;
-    }
-    return std::make_pair(sum, total);
+    return std::make_pair(board->material, countBits(board->occupiedBB));
 }
 
-void evaluatePawns(ChessBoard* board, int* score) {
+PawnEntry computePawnEntry(const ChessBoard* board) {
+    PawnEntry entry{};
+    entry.key = board->pawnHash;
     uint64_t wpOrig = board->getPiecesByColor(pawn, WHITE);
     uint64_t bpOrig = board->getPiecesByColor(pawn, BLACK);
     uint64_t wp = wpOrig;
@@ -227,30 +239,29 @@ void evaluatePawns(ChessBoard* board, int* score) {
     bool phalanxFound = false;
     while (wp) {
         Square sq = Square(popLSB(&wp));
-        *score += PAWN_SQUARE_TABLE[sq];
         int file = sqToFile(sq);
         filesWhite[file]++;
         uint64_t neighbors = fileNeighbors[file] & wpOrig;
         if (neighbors == 0) {
             if (filesWhite[file] >= 2)
-                *score += DOUBLED_AND_ISOLATED;
+                entry.score += DOUBLED_AND_ISOLATED;
             else
-                *score += ISOLATED_PAWN;
-            if (board->squareArray[sq + Square(NORTH)].getColor() == BLACK)
-                *score += ISOLATED_PAWN_BLOCKED;
+                entry.score += ISOLATED_PAWN;
+            entry.isolated[WHITE] |= S_TO_BB[sq];
         } else if (!phalanxFound && sqToRank(sq) >= R4 && sqToFile(sq) >= C && sqToFile(sq) <= F) {
             while (neighbors) {
                 Square nsq = Square(popLSB(&neighbors));
                 if (sqToRank(nsq) == sqToRank(sq)) {
                     phalanxFound = true;
-                    *score += PHALANX_VALUE;
+                    entry.score += PHALANX_VALUE;
                 }
             }
         }
         uint64_t enemyNeighbors = (FILE_MASKS[sqToFile(sq)] | fileNeighbors[sqToFile(sq)]) & bpOrig;
         if (enemyNeighbors == 0) {
-            *score += PASSED_PAWN;
-            *score += PASSED_PAWN_RANK_WHITE[sqToRank(sq)];
+            entry.score += PASSED_PAWN;
+            entry.score += PASSED_PAWN_RANK_WHITE[sqToRank(sq)];
+            entry.passed[WHITE] |= S_TO_BB[sq];
         } else {
             bool passedAhead = true;
             while (enemyNeighbors) {
@@ -259,38 +270,38 @@ void evaluatePawns(ChessBoard* board, int* score) {
                     passedAhead = false;
             }
             if (passedAhead) {
-                *score += PASSED_PAWN;
-                *score += PASSED_PAWN_RANK_WHITE[sqToRank(sq)];
+                entry.score += PASSED_PAWN;
+                entry.score += PASSED_PAWN_RANK_WHITE[sqToRank(sq)];
+                entry.passed[WHITE] |= S_TO_BB[sq];
             }
         }
     }
     phalanxFound = false;
     while (bp) {
         Square sq = Square(popLSB(&bp));
-        *score -= PAWN_SQUARE_TABLE[REVERSE_PSQ[sq]];
         int file = sqToFile(sq);
         filesBlack[file]++;
         uint64_t neighbors = fileNeighbors[file] & bpOrig;
         if (neighbors == 0) {
             if (filesBlack[file] >= 2)
-                *score -= DOUBLED_AND_ISOLATED;
+                entry.score -= DOUBLED_AND_ISOLATED;
             else
-                *score -= ISOLATED_PAWN;
-            if (board->squareArray[sq + Square(SOUTH)].getColor() == WHITE)
-                *score -= ISOLATED_PAWN_BLOCKED;
+                entry.score -= ISOLATED_PAWN;
+            entry.isolated[BLACK] |= S_TO_BB[sq];
         } else if (!phalanxFound && sqToRank(sq) <= R5 && sqToFile(sq) >= C && sqToFile(sq) <= F) {
             while (neighbors) {
                 Square nsq = Square(popLSB(&neighbors));
                 if (sqToRank(nsq) == sqToRank(sq)) {
                     phalanxFound = true;
-                    *score -= PHALANX_VALUE;
+                    entry.score -= PHALANX_VALUE;
                 }
             }
         }
         uint64_t enemyNeighbors = (FILE_MASKS[sqToFile(sq)] | fileNeighbors[sqToFile(sq)]) & wpOrig;
         if (enemyNeighbors == 0) {
-            *score -= PASSED_PAWN;
-            *score -= PASSED_PAWN_RANK_BLACK[sqToRank(sq)];
+            entry.score -= PASSED_PAWN;
+            entry.score -= PASSED_PAWN_RANK_BLACK[sqToRank(sq)];
+            entry.passed[BLACK] |= S_TO_BB[sq];
         } else {
             bool passedAhead = true;
             while (enemyNeighbors) {
@@ -299,21 +310,47 @@ void evaluatePawns(ChessBoard* board, int* score) {
                     passedAhead = false;
             }
             if (passedAhead) {
-                *score -= PASSED_PAWN;
-                *score -= PASSED_PAWN_RANK_BLACK[sqToRank(sq)];
+                entry.score -= PASSED_PAWN;
+                entry.score -= PASSED_PAWN_RANK_BLACK[sqToRank(sq)];
+                entry.passed[BLACK] |= S_TO_BB[sq];
             }
         }
     }
     for (int i = A_FILE; i <= H_FILE; i++) {
         if (filesWhite[i] == 2)
-            *score += DOUBLED_PAWN_BY_FILE[i];
+            entry.score += DOUBLED_PAWN_BY_FILE[i];
         if (filesWhite[i] == 3)
-            *score += TRIPLED_PAWN;
+            entry.score += TRIPLED_PAWN;
         if (filesBlack[i] == 2)
-            *score -= DOUBLED_PAWN_BY_FILE[i];
+            entry.score -= DOUBLED_PAWN_BY_FILE[i];
         if (filesBlack[i] == 3)
-            *score -= TRIPLED_PAWN;
+            entry.score -= TRIPLED_PAWN;
     }
+    return entry;
+}
+
+void evaluatePawns(ChessBoard* board, int* score) {
+    PawnEntry& entry = pawnTable[board->pawnHash & (PAWN_TABLE_SIZE - 1)];
+    pawnTableProbes++;
+    if (entry.key == board->pawnHash)
+        pawnTableHits++;
+    else
+        entry = computePawnEntry(board);
+    *score += entry.score;
+    // A piece sitting in front of an isolated pawn is not part of the pawn key, so the
+    // blocked penalty is applied on top of the cached score.
+    *score += countBits((entry.isolated[WHITE] << 8) & board->colorBitboards[BLACK]) * ISOLATED_PAWN_BLOCKED;
+    *score -= countBits((entry.isolated[BLACK] >> 8) & board->colorBitboards[WHITE]) * ISOLATED_PAWN_BLOCKED;
+}
+
+void clearPawnTable() {
+    pawnTable.assign(PAWN_TABLE_SIZE, PawnEntry{});
+    pawnTableProbes = 0;
+    pawnTableHits = 0;
+}
+
+std::pair<uint64_t, uint64_t> pawnTableStats() {
+    return { pawnTableProbes, pawnTableHits };
 }
 
 void evaluateKnights(ChessBoard* board, int* score) {
@@ -323,13 +360,11 @@ void evaluateKnights(ChessBoard* board, int* score) {
         Square sq = Square(popLSB(&wKnights));
         if (sq == c3 && board->squareArray[c2] == wP)
             *score += CD_PAWN_BLOCKED_BY_PLAYER;
-        *score += KNIGHT_SQUARE_TABLE[sq];
     }
     while (bKnights) {
         Square sq = Square(popLSB(&bKnights));
         if (sq == c6 && board->squareArray[c7] == bP)
             *score -= CD_PAWN_BLOCKED_BY_PLAYER;
-        *score -= KNIGHT_SQUARE_TABLE[REVERSE_PSQ[sq]];
     }
 }
 
@@ -344,7 +379,6 @@ void evaluateBishops(ChessBoard* board, int* score) {
             *score += CD_PAWN_BLOCKED_BY_PLAYER;
         Bitboard atk = getBishopAttacks(sq, board->occupied);
         *score += popCount(atk) * BISHOP_MOBILITY;
-        *score += BISHOP_SQUARE_TABLE[sq];
         wCount++;
     }
     if (wCount >= 2)
@@ -355,7 +389,6 @@ void evaluateBishops(ChessBoard* board, int* score) {
             *score -= CD_PAWN_BLOCKED_BY_PLAYER;
         Bitboard atk = getBishopAttacks(sq, board->occupied);
         *score -= popCount(atk) * BISHOP_MOBILITY;
-        *score -= BISHOP_SQUARE_TABLE[REVERSE_PSQ[sq]];
         bCount++;
     }
     if (bCount >= 2)
@@ -375,7 +408,6 @@ void evaluateRooks(ChessBoard* board, int* score) {
         else if (pawnsOnFile == 1)
             *score += ROOK_SEMI_OPEN_FILE;
         *score += popCount(atk) * ROOK_MOBILITY;
-        *score += ROOK_SQUARE_TABLE[sq];
     }
     while (bRooks) {
         Square sq = Square(popLSB(&bRooks));
@@ -386,7 +418,6 @@ void evaluateRooks(ChessBoard* board, int* score) {
         else if (pawnsOnFile == 1)
             *score -= ROOK_SEMI_OPEN_FILE;
         *score -= popCount(atk) * ROOK_MOBILITY;
-        *score -= ROOK_SQUARE_TABLE[REVERSE_PSQ[sq]];
     }
 }
 
@@ -399,7 +430,6 @@ void evaluateQueens(ChessBoard* board, int* score) {
             *score += QUEEN_EARLY;
         Bitboard atk = getBishopAttacks(sq, board->occupied) | getRookAttacks(sq, board->occupied);
         *score += popCount(atk) * QUEEN_MOBILITY;
-        *score += QUEEN_SQUARE_TABLE[sq];
     }
     while (bQueens) {
         Square sq = Square(popLSB(&bQueens));
@@ -407,7 +437,6 @@ void evaluateQueens(ChessBoard* board, int* score) {
             *score -= QUEEN_EARLY;
         Bitboard atk = getBishopAttacks(sq, board->occupied) | getRookAttacks(sq, board->occupied);
         *score -= popCount(atk) * QUEEN_MOBILITY;
-        *score -= QUEEN_SQUARE_TABLE[REVERSE_PSQ[sq]];
     }
 }
 
@@ -416,12 +445,10 @@ void evaluateKings(ChessBoard* board, int* score, int totalPieces) {
     bool endgame = (totalPieces <= 25 && noQueens);
     Square wk = Square(bitScanForward(board->getPiecesByColor(king, WHITE)));
     Square bk = Square(bitScanForward(board->getPiecesByColor(king, BLACK)));
-    if (endgame) {
-        *score += KING_SQUARE_TABLE_ENDGAME[wk];
-        *score -= KING_SQUARE_TABLE_ENDGAME[REVERSE_PSQ[bk]];
-    } else {
-        *score += KING_SQUARE_TABLE_MIDDLEGAME[wk];
-        *score -= KING_SQUARE_TABLE_MIDDLEGAME[REVERSE_PSQ[bk]];
+    // Every piece-square term is accumulated by the board; the king tables are the only
+    // ones that differ between the phases.
+    *score += board->psqScore[endgame ? ENDGAME : MIDDLEGAME];
+    if (!endgame) {
         if (!board->whiteHasCastled && !board->whiteKingsideCastling && !board->whiteQueensideCastling) {
             Bitboard wp = board->pieceBitboards[wP];
             Bitboard nw = shiftBitboard(S_TO_BB[wk], NW) & wp;
@@ -2,13 +2,34 @@
 #define EVALUATION_H
 
 #include "Board.h"
+#include <array>
+#include <cstdint>
 #include <utility>
 
 namespace Chess {
 
+enum GamePhase { MIDDLEGAME, ENDGAME };
+
+// Material and piece-square value of each piece, signed from white's point of view.
+// ChessBoard keeps running sums of these as pieces are placed, moved and removed.
+extern const std::array<int, 13> pieceMaterial;
+extern const std::array<std::array<std::array<int, 64>, 13>, 2> pieceSquareValues;
+
+// Cached pawn-structure evaluation, keyed by ChessBoard::pawnHash. The score is
+// white-relative and covers every pawn term that depends on pawns alone.
+struct PawnEntry {
+    uint64_t key;
+    int score;
+    std::array<uint64_t, 2> passed;
+    std::array<uint64_t, 2> isolated;
+};
+
 int evaluatePosition(ChessBoard* board);
 std::pair<int, int> totalMaterialAndPieces(ChessBoard* board);
 void evaluatePawns(ChessBoard* board, int* score);
+PawnEntry computePawnEntry(const ChessBoard* board);
+void clearPawnTable();
+std::pair<uint64_t, uint64_t> pawnTableStats();
 void evaluateKnights(ChessBoard* board, int* score);
 void evaluateBishops(ChessBoard* board, int* score);
 void evaluateRooks(ChessBoard* board, int* score);
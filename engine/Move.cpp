@@ -0,0 +1,68 @@
+#include "Move.h"
+
+namespace Chess {
+
+const std::array<PieceType, 4> PROMOTION_TYPES = { knight, bishop, rook, queen };
+
+std::string PackedMove::toUCI() const {
+    // UCI's null move, sent as the best move when there is no legal one.
+    if (isNull())
+        return "0000";
+    std::string uci = squareToStringMap.at(from()) + squareToStringMap.at(to());
+    if (isPromotion())
+        uci += pieceToString(getCP(BLACK, promotionType()));
+    return uci;
+}
+
+PackedMove packMove(const Move& mv) {
+    uint16_t flags = FLAG_QUIET;
+    switch (mv.moveType) {
+        case QUIET: flags = FLAG_QUIET; break;
+        case CAPTURE: flags = FLAG_CAPTURE; break;
+        case KCASTLE: flags = FLAG_KCASTLE; break;
+        case QCASTLE: flags = FLAG_QCASTLE; break;
+        case ENPASSANT: flags = FLAG_ENPASSANT; break;
+        case PROMOTION: flags = FLAG_PROMOTION; break;
+        case CAPTUREANDPROMOTION: flags = FLAG_CAPTURE_PROMOTION; break;
+    }
+    if (mv.moveType == PROMOTION || mv.moveType == CAPTUREANDPROMOTION) {
+        for (uint16_t i = 0; i < PROMOTION_TYPES.size(); i++) {
+            if (getCP(mv.movedColor, PROMOTION_TYPES[i]) == mv.promotionPiece)
+                flags |= i;
+        }
+    }
+    return PackedMove(mv.src, mv.dest, flags);
+}
+
+Move unpackMove(PackedMove mv, const ChessBoard* board) {
+    Move full;
+    full.src = mv.from();
+    full.dest = mv.to();
+    full.mPiece = board->squareArray[mv.from()];
+    full.movedColor = getPieceColor(full.mPiece);
+    full.capturedPiece = board->squareArray[mv.to()];
+    full.promotionPiece = EMPTY;
+    full.isNull = mv.isNull();
+    uint16_t flags = mv.flags();
+    if (flags >= FLAG_CAPTURE_PROMOTION) {
+        full.moveType = CAPTUREANDPROMOTION;
+        full.promotionPiece = getCP(full.movedColor, mv.promotionType());
+    } else if (flags >= FLAG_PROMOTION) {
+        full.moveType = PROMOTION;
+        full.promotionPiece = getCP(full.movedColor, mv.promotionType());
+    } else if (flags == FLAG_ENPASSANT) {
+        full.moveType = ENPASSANT;
+        full.capturedPiece = getCP(reverseColor(full.movedColor), pawn);
+    } else if (flags == FLAG_KCASTLE) {
+        full.moveType = KCASTLE;
+    } else if (flags == FLAG_QCASTLE) {
+        full.moveType = QCASTLE;
+    } else if (flags == FLAG_CAPTURE) {
+        full.moveType = CAPTURE;
+    } else {
+        full.moveType = QUIET;
+    }
+    return full;
+}
+
+}
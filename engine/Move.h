@@ -2,6 +2,8 @@
 #define MOVE_H
 
 #include <string>
+#include <array>
+#include <cstdint>
 #include "Constants.h"
 #include "Board.h"
 
@@ -18,8 +20,54 @@ struct Move {
     bool isNull;
 
     std::string toUCI() const;
+    bool operator==(const Move& other) const {
+        return src == other.src && dest == other.dest && promotionPiece == other.promotionPiece;
+    }
+    bool operator!=(const Move& other) const {
+        return !(*this == other);
+    }
 };
 
+// Flags stored in the top four bits of a PackedMove. For promotions the low two bits
+// select the piece (knight, bishop, rook, queen).
+enum MoveFlag : uint16_t {
+    FLAG_QUIET = 0,
+    FLAG_CAPTURE = 1,
+    FLAG_KCASTLE = 2,
+    FLAG_QCASTLE = 3,
+    FLAG_ENPASSANT = 4,
+    FLAG_PROMOTION = 8,
+    FLAG_CAPTURE_PROMOTION = 12
+};
+
+extern const std::array<PieceType, 4> PROMOTION_TYPES;
+
+// 16-bit move: bits 0-5 source square, bits 6-11 destination square, bits 12-15 flags.
+// Pieces are not stored; they are read from the board's squareArray when needed.
+struct PackedMove {
+    uint16_t data;
+
+    PackedMove() = default;
+    constexpr explicit PackedMove(uint16_t d) : data(d) {}
+    constexpr PackedMove(Square from, Square to, uint16_t flags)
+        : data(uint16_t(int(from) | (int(to) << 6) | (flags << 12))) {}
+
+    Square from() const { return Square(data & 0x3F); }
+    Square to() const { return Square((data >> 6) & 0x3F); }
+    uint16_t flags() const { return data >> 12; }
+    bool isNull() const { return data == 0; }
+    bool isCapture() const { return flags() == FLAG_CAPTURE || flags() == FLAG_ENPASSANT || flags() >= FLAG_CAPTURE_PROMOTION; }
+    bool isPromotion() const { return (flags() & FLAG_PROMOTION) != 0; }
+    PieceType promotionType() const { return PROMOTION_TYPES[flags() & 3]; }
+    std::string toUCI() const;
+    bool operator==(const PackedMove& other) const { return data == other.data; }
+    bool operator!=(const PackedMove& other) const { return data != other.data; }
+};
+
+const PackedMove NULL_MOVE(0);
+
+PackedMove packMove(const Move& mv);
+Move unpackMove(PackedMove mv, const ChessBoard* board);
 Move uciToMove(const std::string& uci, ChessBoard* board);
 
 }
@@ -5,7 +5,7 @@
 
 namespace Chess {
 
-int MoveGenerator::countPins(ChessBoard* board, Color opp, uint64_t occ, Square kingPos) {
+int MoveGenerator::countPins(const ChessBoard* board, Color opp, uint64_t occ, Square kingPos) {
     uint64_t diagOpp = board->getPiecesByColor(rook, opp) | board->getPiecesByColor(queen, opp);
     uint64_t orthoOpp = board->getPiecesByColor(bishop, opp) | board->getPiecesByColor(queen, opp);
     uint64_t cand = getBishopAttacks(kingPos, board->colorBitboards[opp]) & diagOpp;
@@ -20,7 +20,7 @@ int MoveGenerator::countPins(ChessBoard* board, Color opp, uint64_t occ, Square
     return pinCount;
 }
 
-uint64_t MoveGenerator::allAttacks(ChessBoard* board, Color opp, uint64_t occ, uint64_t ortho, uint64_t diag) {
+uint64_t MoveGenerator::allAttacks(const ChessBoard* board, Color opp, uint64_t occ, uint64_t ortho, uint64_t diag) {
     uint64_t att = 0;
     uint64_t kingXray = board->getPiecesByColor(king, reverseColor(opp));
     Square oppKing = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, opp)));
@@ -60,562 +60,430 @@ uint64_t MoveGenerator::knightAttacks(Square sq) {
 }
 
 uint64_t MoveGenerator::getBishopAttacks(Square sq, uint64_t blockers) {
-    uint64_t index = (blockers & bishopMasks[sq]) * BISHOP_MAGICS[sq];
-    return BISHOP_ATTACKS[sq][index >> bishopShifts[sq]];
+    if (sliderBackend == PEXT_BACKEND)
+        return pextBishopAttacks(sq, blockers);
+    uint64_t index = (blockers & bishopMasks[sq]) * bishopMagics[sq];
+    return bishopAttacks[bishopOffsets[sq] + (index >> bishopShifts[sq])];
 }
 
 uint64_t MoveGenerator::getRookAttacks(Square sq, uint64_t blockers) {
-    uint64_t index = (blockers & rookMasks[sq]) * ROOK_MAGICS[sq];
-    return ROOK_ATTACKS[sq][index >> rookShifts[sq]];
+    if (sliderBackend == PEXT_BACKEND)
+        return pextRookAttacks(sq, blockers);
+    uint64_t index = (blockers & rookMasks[sq]) * rookMagics[sq];
+    return rookAttacks[rookOffsets[sq] + (index >> rookShifts[sq])];
 }
 
-void MoveGenerator::genMovesFromLocations(ChessBoard* board, std::vector<Move>& moves, Square origin, uint64_t locs, Color c) {
+template<GenType Type>
+void MoveGenerator::genMovesFromLocations(const ChessBoard* board, MoveList& moves, Square origin, uint64_t locs) {
     while (locs) {
         int pos = popLeastSignificantBit(&locs);
-        uint64_t targetBB = S_TO_BB[pos];
-        Piece pc = board->squareArray[origin];
-        if (pc == wP && (targetBB & RANK_MASKS[R8]) != 0) {
-            Move m1 { origin, static_cast<Square>(pos), PROMOTION, wP, board->squareArray[pos], c, wN, false };
-            Move m2 { origin, static_cast<Square>(pos), PROMOTION, wP, board->squareArray[pos], c, wR, false };
-            Move m3 { origin, static_cast<Square>(pos), PROMOTION, wP, board->squareArray[pos], c, wQ, false };
-            Move m4 { origin, static_cast<Square>(pos), PROMOTION, wP, board->squareArray[pos], c, wB, false };
-            moves.push_back(m1); moves.push_back(m2); moves.push_back(m3); moves.push_back(m4);
-        } else if (pc == bP && (targetBB & RANK_MASKS[R1]) != 0) {
-            Move m1 { origin, static_cast<Square>(pos), PROMOTION, bP, board->squareArray[pos], c, bN, false };
-            Move m2 { origin, static_cast<Square>(pos), PROMOTION, bP, board->squareArray[pos], c, bR, false };
-            Move m3 { origin, static_cast<Square>(pos), PROMOTION, bP, board->squareArray[pos], c, bQ, false };
-            Move m4 { origin, static_cast<Square>(pos), PROMOTION, bP, board->squareArray[pos], c, bB, false };
-            moves.push_back(m1); moves.push_back(m2); moves.push_back(m3); moves.push_back(m4);
-        } else {
-            Move newMv { origin, static_cast<Square>(pos), (board->squareArray[pos] == EMPTY) ? QUIET : CAPTURE, pc, board->squareArray[pos], c, EMPTY, false };
-            moves.push_back(newMv);
-        }
+        uint16_t flags;
+        if constexpr (Type == CAPTURES)
+            flags = FLAG_CAPTURE;
+        else if constexpr (Type == QUIETS || Type == QUIET_CHECKS)
+            flags = FLAG_QUIET;
+        else
+            flags = (board->occupiedBB & S_TO_BB[pos]) ? FLAG_CAPTURE : FLAG_QUIET;
+        moves.push_back(PackedMove(origin, static_cast<Square>(pos), flags));
     }
 }
 
-void MoveGenerator::getKingMoves(ChessBoard* board, std::vector<Move>& moves, Square kingSq, uint64_t attacked, uint64_t own, Color c) {
-    uint64_t kingMv = kingAttacks(kingSq) & ~attacked & ~own;
-    genMovesFromLocations(board, moves, kingSq, kingMv, c);
+// Serializes a set of pawn targets that were all reached by shifting the pawn set in
+// direction D, so the origin of each target is recovered with a single subtraction.
+template<int D>
+static void serializePawnMoves(MoveList& moves, uint64_t targets, uint64_t pinned, Square kingSq, uint16_t flags) {
+    while (targets) {
+        int to = popLeastSignificantBit(&targets);
+        int from = to - D;
+        if ((pinned & S_TO_BB[from]) && !(LINE[kingSq][from] & S_TO_BB[to]))
+            continue;
+        moves.push_back(PackedMove(static_cast<Square>(from), static_cast<Square>(to), flags));
+    }
 }
 
-void MoveGenerator::getKnightMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t knights, uint64_t pinned, uint64_t own, Color c, uint64_t allowed) {
-    knights &= ~pinned;
-    while (knights) {
-        int pos = popLeastSignificantBit(&knights);
-        uint64_t nMoves = knightAttacks(static_cast<Square>(pos)) & ~own & allowed;
-        genMovesFromLocations(board, moves, static_cast<Square>(pos), nMoves, c);
+template<int D, bool QueenOnly = false>
+static void serializePromotions(MoveList& moves, uint64_t targets, uint64_t pinned, Square kingSq, bool capture) {
+    uint16_t flags = capture ? FLAG_CAPTURE_PROMOTION : FLAG_PROMOTION;
+    while (targets) {
+        int to = popLeastSignificantBit(&targets);
+        int from = to - D;
+        if ((pinned & S_TO_BB[from]) && !(LINE[kingSq][from] & S_TO_BB[to]))
+            continue;
+        Square f = static_cast<Square>(from);
+        Square t = static_cast<Square>(to);
+        if constexpr (QueenOnly) {
+            moves.push_back(PackedMove(f, t, flags | 3));
+            continue;
+        }
+        moves.push_back(PackedMove(f, t, flags | 0));
+        moves.push_back(PackedMove(f, t, flags | 2));
+        moves.push_back(PackedMove(f, t, flags | 3));
+        moves.push_back(PackedMove(f, t, flags | 1));
     }
 }
 
-void MoveGenerator::getPawnMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t pawns, uint64_t pinned, uint64_t occ, uint64_t opp, Color c, uint64_t allowed) {
-    uint64_t pinnedPawns = pawns & pinned;
-    uint64_t sqBB;
-    Square kingPos;
-    if (pinnedPawns) {
-        while (pinnedPawns) {
-            int pos = popLeastSignificantBit(&pinnedPawns);
-            sqBB = S_TO_BB[pos];
-            kingPos = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, c)));
-            uint64_t pMoves = (shiftBitboard(sqBB, PAWN_PUSH_DIRECTION[c]) & ~occ) & allowed & LINE[kingPos][pos];
-            if (pMoves) {
-                if (sqBB & RANK_MASKS[STARTING_RANK[c]])
-                    pMoves |= (shiftBitboard(sqBB, PAWN_PUSH_DIRECTION[c]*2) & ~occ) & allowed & LINE[kingPos][pos];
-            }
-            pMoves |= colorToPawnLookup[c][pos] & opp & allowed & LINE[kingPos][pos];
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), pMoves, c);
-        }
+// Pawns are generated setwise: the whole pawn set is shifted once per direction and
+// masked by empties, enemies and the target set, and only the results are serialized.
+// Pinned pawns are filtered against their pin line at serialization time.
+template<Color Us, GenType Type>
+void MoveGenerator::getPawnMoves(const ChessBoard* board, MoveList& moves, uint64_t pinned, uint64_t target, Square kingSq, const CheckInfo& ci) {
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    constexpr Direction Up = Us == WHITE ? NORTH : SOUTH;
+    constexpr Direction UpWest = Us == WHITE ? NW : SW;
+    constexpr Direction UpEast = Us == WHITE ? NE : SE;
+    constexpr Rank Rank3 = Us == WHITE ? R3 : R6;
+    constexpr Rank Rank7 = Us == WHITE ? R7 : R2;
+    uint64_t empty = ~board->occupiedBB;
+    uint64_t enemies = board->colorBitboards[Them] & target;
+    uint64_t pawns = board->getPiecesByColor(pawn, Us);
+    uint64_t promoPawns = pawns & RANK_MASKS[Rank7];
+    uint64_t others = pawns & ~RANK_MASKS[Rank7];
+    if constexpr (Type == QUEEN_PROMOTIONS) {
+        serializePromotions<Up, true>(moves, shiftBitboard(promoPawns, Up) & empty & target, pinned, kingSq, false);
+        return;
     }
-    uint64_t unpinnedPawns = pawns & ~pinned;
-    while (unpinnedPawns) {
-        int pos = popLeastSignificantBit(&unpinnedPawns);
-        sqBB = S_TO_BB[pos];
-        uint64_t pMoves = (shiftBitboard(sqBB, PAWN_PUSH_DIRECTION[c]) & ~occ) & allowed;
-        if (board->squareArray[pos + PAWN_PUSH_DIRECTION[c]] == EMPTY) {
-            if (sqBB & RANK_MASKS[STARTING_RANK[c]])
-                pMoves |= (shiftBitboard(sqBB, PAWN_PUSH_DIRECTION[c]*2) & ~occ) & allowed;
+    if constexpr (Type != CAPTURES) {
+        uint64_t single = shiftBitboard(others, Up) & empty;
+        uint64_t dbl = shiftBitboard(single & RANK_MASKS[Rank3], Up) & empty;
+        single &= target;
+        dbl &= target;
+        if constexpr (Type == QUIET_CHECKS) {
+            // A push only keeps a discovery line blocked when that line is the pawn's file.
+            uint64_t dcPawns = others & ci.discoverers & ~FILE_MASKS[ci.theirKing & 7];
+            uint64_t dcSingle = shiftBitboard(dcPawns, Up);
+            uint64_t dcDouble = shiftBitboard(dcSingle & RANK_MASKS[Rank3], Up);
+            single &= ci.checkSquares[pawn] | dcSingle;
+            dbl &= ci.checkSquares[pawn] | dcDouble;
         }
-        if (c == WHITE)
-            pMoves |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[pos] & opp) & allowed;
-        else
-            pMoves |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[pos] & opp) & allowed;
-        genMovesFromLocations(board, moves, static_cast<Square>(pos), pMoves, c);
+        serializePawnMoves<Up>(moves, single, pinned, kingSq, FLAG_QUIET);
+        serializePawnMoves<2 * Up>(moves, dbl, pinned, kingSq, FLAG_QUIET);
     }
-}
-
-void MoveGenerator::getBishopMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t bishops, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed) {
-    uint64_t pinnedBishops = bishops & pinned;
-    Square kingPos;
-    if (pinnedBishops) {
-        while (pinnedBishops) {
-            int pos = popLeastSignificantBit(&pinnedBishops);
-            kingPos = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, c)));
-            uint64_t poss = getBishopAttacks(static_cast<Square>(pos), board->occupied) & LINE[kingPos][pos] & allowed & ~own;
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), poss, c);
+    // Promotions are tactical moves and belong to the capture stage, not quiet checks.
+    if constexpr (Type != QUIET_CHECKS) {
+        if (promoPawns) {
+            if constexpr (Type != CAPTURES)
+                serializePromotions<Up>(moves, shiftBitboard(promoPawns, Up) & empty & target, pinned, kingSq, false);
+            if constexpr (Type != QUIETS) {
+                serializePromotions<UpWest>(moves, shiftBitboard(promoPawns, UpWest) & enemies, pinned, kingSq, true);
+                serializePromotions<UpEast>(moves, shiftBitboard(promoPawns, UpEast) & enemies, pinned, kingSq, true);
+            }
         }
     }
-    uint64_t freeBishops = bishops & ~pinned;
-    while (freeBishops) {
-        int pos = popLeastSignificantBit(&freeBishops);
-        uint64_t bMoves = getBishopAttacks(static_cast<Square>(pos), own | opp) & ~own & allowed;
-        genMovesFromLocations(board, moves, static_cast<Square>(pos), bMoves, c);
+    if constexpr (Type != QUIETS && Type != QUIET_CHECKS) {
+        serializePawnMoves<UpWest>(moves, shiftBitboard(others, UpWest) & enemies, pinned, kingSq, FLAG_CAPTURE);
+        serializePawnMoves<UpEast>(moves, shiftBitboard(others, UpEast) & enemies, pinned, kingSq, FLAG_CAPTURE);
     }
 }
 
-void MoveGenerator::getRookMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t rooks, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed) {
-    uint64_t pinnedRooks = rooks & pinned;
-    Square kingPos;
-    if (pinnedRooks) {
-        while (pinnedRooks) {
-            int pos = popLeastSignificantBit(&pinnedRooks);
-            kingPos = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, c)));
-            uint64_t poss = getRookAttacks(static_cast<Square>(pos), board->occupied) & LINE[kingPos][pos] & allowed & ~own;
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), poss, c);
+template<Color Us, PieceType Pt, GenType Type>
+void MoveGenerator::getPieceMoves(const ChessBoard* board, MoveList& moves, uint64_t pinned, uint64_t target, Square kingSq, const CheckInfo& ci) {
+    uint64_t occ = board->occupiedBB;
+    uint64_t pieces = board->getPiecesByColor(Pt, Us);
+    if constexpr (Pt == knight)
+        pieces &= ~pinned;
+    while (pieces) {
+        int pos = popLeastSignificantBit(&pieces);
+        Square sq = static_cast<Square>(pos);
+        uint64_t pMoves;
+        if constexpr (Pt == knight)
+            pMoves = knightAttacks(sq);
+        else if constexpr (Pt == bishop)
+            pMoves = getBishopAttacks(sq, occ);
+        else if constexpr (Pt == rook)
+            pMoves = getRookAttacks(sq, occ);
+        else
+            pMoves = getBishopAttacks(sq, occ) | getRookAttacks(sq, occ);
+        pMoves &= target;
+        if (S_TO_BB[pos] & pinned)
+            pMoves &= LINE[kingSq][pos];
+        if constexpr (Type == QUIET_CHECKS) {
+            uint64_t checking = ci.checkSquares[Pt];
+            if (ci.discoverers & S_TO_BB[pos])
+                checking |= ~LINE[ci.theirKing][pos];
+            pMoves &= checking;
         }
-    }
-    uint64_t freeRooks = rooks & ~pinned;
-    while (freeRooks) {
-        int pos = popLeastSignificantBit(&freeRooks);
-        uint64_t rMoves = getRookAttacks(static_cast<Square>(pos), own | opp) & ~own & allowed;
-        genMovesFromLocations(board, moves, static_cast<Square>(pos), rMoves, c);
+        genMovesFromLocations<Type>(board, moves, sq, pMoves);
     }
 }
 
-void MoveGenerator::getQueenMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t queens, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed) {
-    uint64_t pinnedQueens = queens & pinned;
-    Square kingPos;
-    if (pinnedQueens) {
-        while (pinnedQueens) {
-            int pos = popLeastSignificantBit(&pinnedQueens);
-            kingPos = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, c)));
-            uint64_t poss = (getBishopAttacks(static_cast<Square>(pos), board->occupied) | getRookAttacks(static_cast<Square>(pos), board->occupied))
-                            & LINE[kingPos][pos] & allowed & ~own;
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), poss, c);
-        }
-    }
-    uint64_t freeQueens = queens & ~pinned;
-    while (freeQueens) {
-        int pos = popLeastSignificantBit(&freeQueens);
-        uint64_t rMoves = getRookAttacks(static_cast<Square>(pos), own | opp) & ~own & allowed;
-        uint64_t bMoves = getBishopAttacks(static_cast<Square>(pos), own | opp) & ~own & allowed;
-        genMovesFromLocations(board, moves, static_cast<Square>(pos), rMoves | bMoves, c);
-    }
+template<Color Us>
+void MoveGenerator::getCastlingMoves(const ChessBoard* board, MoveList& moves, uint64_t attacked) {
+    constexpr Square KingFrom = Us == WHITE ? e1 : e8;
+    constexpr Square KingTo = Us == WHITE ? g1 : g8;
+    constexpr Square QueenTo = Us == WHITE ? c1 : c8;
+    constexpr Square KingRook = Us == WHITE ? h1 : h8;
+    constexpr Square QueenRook = Us == WHITE ? a1 : a8;
+    constexpr Piece Rook = Us == WHITE ? wR : bR;
+    constexpr uint64_t KingPath = Us == WHITE ? 0x60ULL : 0x6000000000000000ULL;           // f, g
+    constexpr uint64_t QueenPath = Us == WHITE ? 0xCULL : 0x0C00000000000000ULL;           // c, d
+    constexpr uint64_t QueenEmpty = Us == WHITE ? 0xEULL : 0x0E00000000000000ULL;          // b, c, d
+    bool kingSide = Us == WHITE ? board->whiteKingsideCastling : board->blackKingsideCastling;
+    bool queenSide = Us == WHITE ? board->whiteQueensideCastling : board->blackQueensideCastling;
+    uint64_t occ = board->occupiedBB;
+    if (kingSide && (KingPath & (occ | attacked)) == 0 && board->squareArray[KingRook] == Rook)
+        moves.push_back(PackedMove(KingFrom, KingTo, FLAG_KCASTLE));
+    if (queenSide && (QueenEmpty & occ) == 0 && (QueenPath & attacked) == 0 && board->squareArray[QueenRook] == Rook)
+        moves.push_back(PackedMove(KingFrom, QueenTo, FLAG_QCASTLE));
 }
 
-void MoveGenerator::getCastlingMoves(ChessBoard* board, std::vector<Move>& moves, Square kingSq, uint64_t attacked, Color c) {
-    bool canKingSide = false;
-    bool canQueenSide = false;
-    uint64_t avail = ~attacked & board->emptyBB;
-    if (c == WHITE) {
-        canKingSide = ((S_TO_BB[f1] & avail) != 0) && ((S_TO_BB[g1] & avail) != 0);
-        canQueenSide = ((S_TO_BB[b1] & board->emptyBB) != 0) && ((S_TO_BB[c1] & avail) != 0) && ((S_TO_BB[d1] & avail) != 0);
-        if (board->whiteKingsideCastling && canKingSide && board->squareArray[h1] == wR)
-            moves.push_back(Move{ e1, g1, KCASTLE, wK, EMPTY, WHITE, EMPTY, false });
-        if (board->whiteQueensideCastling && canQueenSide && board->squareArray[a1] == wR)
-            moves.push_back(Move{ e1, c1, QCASTLE, wK, EMPTY, WHITE, EMPTY, false });
-    } else {
-        canKingSide = ((S_TO_BB[f8] & avail) != 0) && ((S_TO_BB[g8] & avail) != 0);
-        canQueenSide = ((S_TO_BB[b8] & board->emptyBB) != 0) && ((S_TO_BB[c8] & avail) != 0) && ((S_TO_BB[d8] & avail) != 0);
-        if (board->blackKingsideCastling && canKingSide && board->squareArray[h8] == bR)
-            moves.push_back(Move{ e8, g8, KCASTLE, bK, EMPTY, BLACK, EMPTY, false });
-        if (board->blackQueensideCastling && canQueenSide && board->squareArray[a8] == bR)
-            moves.push_back(Move{ e8, c8, QCASTLE, bK, EMPTY, BLACK, EMPTY, false });
+template<Color Us>
+static CheckInfo computeCheckInfo(const ChessBoard* board) {
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    const auto& theirPawnAttacks = Us == WHITE ? BLACK_PAWN_ATTACKS_SQUARE_LOOKUP : WHITE_PAWN_ATTACKS_SQUARE_LOOKUP;
+    CheckInfo ci{};
+    uint64_t occ = board->occupiedBB;
+    Square tk = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, Them)));
+    ci.theirKing = tk;
+    ci.checkSquares[pawn] = theirPawnAttacks[tk];
+    ci.checkSquares[knight] = MoveGenerator::knightAttacks(tk);
+    ci.checkSquares[bishop] = MoveGenerator::getBishopAttacks(tk, occ);
+    ci.checkSquares[rook] = MoveGenerator::getRookAttacks(tk, occ);
+    ci.checkSquares[queen] = ci.checkSquares[bishop] | ci.checkSquares[rook];
+    ci.checkSquares[king] = 0;
+    ci.discoverers = 0;
+    uint64_t orthoOwn = board->getPiecesByColor(rook, Us) | board->getPiecesByColor(queen, Us);
+    uint64_t diagOwn = board->getPiecesByColor(bishop, Us) | board->getPiecesByColor(queen, Us);
+    uint64_t snipers = (MoveGenerator::getBishopAttacks(tk, 0) & diagOwn) | (MoveGenerator::getRookAttacks(tk, 0) & orthoOwn);
+    while (snipers) {
+        int pos = popLeastSignificantBit(&snipers);
+        uint64_t between = SQUARES_BETWEEN[tk][pos] & occ;
+        if (between && (between & (between - 1)) == 0 && (between & board->colorBitboards[Us]))
+            ci.discoverers |= between;
     }
+    return ci;
 }
 
-std::vector<Move> MoveGenerator::generateLegalMoves(ChessBoard* board) {
-    std::vector<Move> allMoves;
-    Color pl = board->sideToMove;
-    Color op = reverseColor(pl);
-    uint64_t ownPieces = board->colorBitboards[pl];
-    uint64_t oppPieces = board->colorBitboards[op];
-    uint64_t pawns = board->getPiecesByColor(pawn, pl);
-    uint64_t allowed = 0xFFFFFFFFFFFFFFFFULL;
-    uint64_t orthoOwn = board->getPiecesByColor(rook, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t diagOwn = board->getPiecesByColor(bishop, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t orthoOpp = board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op);
-    uint64_t diagOpp = board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op);
-    uint64_t att = board->getAllAttacks(op, board->occupiedBB, orthoOpp, diagOpp);
-    Square kingSq = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, pl)));
-    getKingMoves(board, allMoves, kingSq, att, ownPieces, pl);
-    uint64_t checks = 0;
-    if (pl == WHITE)
-        checks |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
-    else
-        checks |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-    checks |= (knightAttacks(kingSq) & board->getPiecesByColor(knight, op));
-    uint64_t cand = (getBishopAttacks(kingSq, board->colorBitboards[op]) & diagOpp);
-    cand |= (getRookAttacks(kingSq, board->colorBitboards[op]) & orthoOpp);
+// The whole generator is instantiated per side to move and generation type, so every
+// colour-dependent direction, rank and lookup table below is a compile-time constant.
+template<Color Us, GenType Type>
+void MoveGenerator::generateAll(const ChessBoard* board, MoveList& moves) {
+    constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+    constexpr Direction Down = Us == WHITE ? SOUTH : NORTH;
+    const auto& ourPawnAttacks = Us == WHITE ? WHITE_PAWN_ATTACKS_SQUARE_LOOKUP : BLACK_PAWN_ATTACKS_SQUARE_LOOKUP;
+    const auto& theirPawnAttacks = Us == WHITE ? BLACK_PAWN_ATTACKS_SQUARE_LOOKUP : WHITE_PAWN_ATTACKS_SQUARE_LOOKUP;
+    uint64_t own = board->colorBitboards[Us];
+    uint64_t opp = board->colorBitboards[Them];
+    uint64_t occ = board->occupiedBB;
+    uint64_t orthoOpp = board->getPiecesByColor(rook, Them) | board->getPiecesByColor(queen, Them);
+    uint64_t diagOpp = board->getPiecesByColor(bishop, Them) | board->getPiecesByColor(queen, Them);
+    Square kingSq = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, Us)));
+    uint64_t checkers = (ourPawnAttacks[kingSq] & board->getPiecesByColor(pawn, Them))
+                      | (knightAttacks(kingSq) & board->getPiecesByColor(knight, Them));
+    uint64_t cand = (getBishopAttacks(kingSq, opp) & diagOpp) | (getRookAttacks(kingSq, opp) & orthoOpp);
     uint64_t pinned = 0;
     while (cand) {
         int pos = popLeastSignificantBit(&cand);
-        uint64_t between = SQUARES_BETWEEN[kingSq][pos] & ownPieces;
+        uint64_t between = SQUARES_BETWEEN[kingSq][pos] & own;
         if (between == 0)
-            checks ^= S_TO_BB[pos];
-        else if (between && ((between & (between - 1)) == 0))
-            pinned ^= between;
-    }
-    int numChecks = popCount(checks);
-    if (numChecks == 2)
-        return allMoves;
-    else if (numChecks == 1) {
-        Square chk = static_cast<Square>(bitScanForward(checks));
-        Piece chkPiece = board->squareArray[chk];
-        Square epShift = board->enPassantSquare + static_cast<Square>(PAWN_PUSH_DIRECTION[op]);
-        if (chk == epShift && (chkPiece == wP || chkPiece == bP)) {
-            uint64_t pawnsCap = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-            uint64_t unpinned = pawnsCap & ~pinned;
-            while (unpinned) {
-                int pos = popLeastSignificantBit(&unpinned);
-                Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], chkPiece, pl, board->squareArray[static_cast<Square>(pos)], false };
-                board->makeMove(mv);
-                if (board->isCheck(pl))
-                    board->undo();
-                else {
-                    board->undo();
-                    allMoves.push_back(mv);
-                }
-            }
-            uint64_t pinPawns = pawnsCap & pinned & LINE[board->enPassantSquare][kingSq];
-            if (pinPawns) {
-                int pos = popLeastSignificantBit(&pinPawns);
-                allMoves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], chkPiece, pl, board->squareArray[static_cast<Square>(pos)], false });
-            }
-        }
-        uint64_t possCaptures = 0;
-        if (pl == WHITE) {
-            possCaptures |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[chk] & board->pieceBitboards[wP]);
-            possCaptures |= (knightAttacks(chk) & board->pieceBitboards[wN]);
-            possCaptures |= (getBishopAttacks(chk, board->occupiedBB) & diagOwn);
-            possCaptures |= (getRookAttacks(chk, board->occupiedBB) & orthoOwn);
-            possCaptures &= ~pinned;
-        } else {
-            possCaptures |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[chk] & board->pieceBitboards[bP]);
-            possCaptures |= (knightAttacks(chk) & board->pieceBitboards[bN]);
-            possCaptures |= (getBishopAttacks(chk, board->occupiedBB) & diagOwn);
-            possCaptures |= (getRookAttacks(chk, board->occupiedBB) & orthoOwn);
-            possCaptures &= ~pinned;
-        }
-        while (possCaptures) {
-            int pos = popLeastSignificantBit(&possCaptures);
-            genMovesFromLocations(board, allMoves, static_cast<Square>(pos), S_TO_BB[kingSq], pl);
-        }
-        if (chkPiece == bN || chkPiece == wN)
-            return allMoves;
-        else if (chkPiece == bP || chkPiece == wP)
-            return allMoves;
-        return allMoves;
+            checkers |= S_TO_BB[pos];
+        else if ((between & (between - 1)) == 0)
+            pinned |= between;
     }
-    uint64_t knights = board->getPiecesByColor(knight, pl);
-    getKnightMoves(board, allMoves, knights, pinned, ownPieces, pl, allowed);
-    getPawnMoves(board, allMoves, pawns, pinned, board->occupiedBB, oppPieces, pl, allowed);
-    getBishopMoves(board, allMoves, diagOwn, pinned, ownPieces, oppPieces, pl, allowed);
-    getRookMoves(board, allMoves, orthoOwn, pinned, ownPieces, oppPieces, pl, allowed);
-    getCastlingMoves(board, allMoves, kingSq, att, pl);
-    if (board->enPassantSquare != EMPTYSQ) {
-        uint64_t epPawns = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-        uint64_t unpinned = epPawns & ~pinned;
-        while (unpinned) {
-            int pos = popLeastSignificantBit(&unpinned);
-            Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false };
-            board->makeMoveNoUpdate(mv);
-            if (board->isCheck(pl))
-                board->undoNoUpdate(mv);
-            else {
-                board->undoNoUpdate(mv);
-                allMoves.push_back(mv);
-            }
-        }
-        uint64_t pinPawns = epPawns & pinned & LINE[board->enPassantSquare][kingSq];
-        if (pinPawns) {
-            int pos = popLeastSignificantBit(&pinPawns);
-            allMoves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false });
-        }
+    if constexpr (Type == QUIET_CHECKS) {
+        if (checkers)
+            return;
     }
-    return allMoves;
-}
-
-std::vector<Move> MoveGenerator::generateCaptures(ChessBoard* board) {
-    std::vector<Move> moves;
-    Color pl = board->sideToMove;
-    Color op = reverseColor(pl);
-    uint64_t own = board->colorBitboards[pl];
-    uint64_t opp = board->colorBitboards[op];
-    uint64_t pawns = board->getPiecesByColor(pawn, pl);
-    uint64_t allowed = opp;
-    uint64_t orthoOwn = board->getPiecesByColor(rook, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t diagOwn = board->getPiecesByColor(bishop, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t orthoOpp = board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op);
-    uint64_t diagOpp = board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op);
-    uint64_t att = board->getAllAttacks(op, board->occupiedBB, orthoOpp, diagOpp);
-    Square kingSq = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, pl)));
-    getKingMoves(board, moves, kingSq, att | ~allowed, own, pl);
-    uint64_t checks = 0;
-    if (pl == WHITE)
-        checks |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
+    uint64_t target;
+    if constexpr (Type == CAPTURES)
+        target = opp;
+    else if constexpr (Type == QUIETS || Type == QUIET_CHECKS || Type == QUEEN_PROMOTIONS)
+        target = ~occ;
     else
-        checks |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-    checks |= (knightAttacks(kingSq) & board->getPiecesByColor(knight, op));
-    uint64_t cand = (getBishopAttacks(kingSq, board->colorBitboards[op]) & diagOpp);
-    cand |= (getRookAttacks(kingSq, board->colorBitboards[op]) & orthoOpp);
-    uint64_t pinned = 0;
-    while (cand) {
-        int pos = popLeastSignificantBit(&cand);
-        uint64_t between = SQUARES_BETWEEN[kingSq][pos] & own;
-        if (between == 0)
-            checks ^= S_TO_BB[pos];
-        else if (between && ((between & (between - 1)) == 0))
-            pinned ^= between;
+        target = ~own;
+    uint64_t attacked = 0;
+    if constexpr (Type != QUIET_CHECKS && Type != QUEEN_PROMOTIONS) {
+        attacked = allAttacks(board, Them, occ, orthoOpp, diagOpp);
+        genMovesFromLocations<Type>(board, moves, kingSq, kingAttacks(kingSq) & ~attacked & target);
     }
-    int numChecks = popCount(checks);
-    if (numChecks == 2)
-        return moves;
-    else if (numChecks == 1) {
-        Square chk = static_cast<Square>(bitScanForward(checks));
-        Piece chkPiece = board->squareArray[chk];
-        Square epShift = board->enPassantSquare + static_cast<Square>(PAWN_PUSH_DIRECTION[op]);
-        if (chk == epShift && (chkPiece == wP || chkPiece == bP)) {
-            uint64_t pawnsCap = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-            uint64_t unpinned = pawnsCap & ~pinned;
-            while (unpinned) {
-                int pos = popLeastSignificantBit(&unpinned);
-                Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], chkPiece, pl, board->squareArray[static_cast<Square>(pos)], false };
-                board->makeMove(mv);
-                if (board->isCheck(pl))
-                    board->undo();
-                else {
-                    board->undo();
-                    moves.push_back(mv);
-                }
-            }
-            uint64_t pinPawns = pawnsCap & pinned & LINE[board->enPassantSquare][kingSq];
-            if (pinPawns) {
-                int pos = popLeastSignificantBit(&pinPawns);
-                moves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false });
-            }
-        }
-        uint64_t possCapt = 0;
-        if (pl == WHITE) {
-            possCapt |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[wN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
-        } else {
-            possCapt |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[bN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
-        }
-        while (possCapt) {
-            int pos = popLeastSignificantBit(&possCapt);
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), S_TO_BB[kingSq], pl);
-        }
-        if (chkPiece == bN || chkPiece == wN)
-            return moves;
-        else if (chkPiece == bP || chkPiece == wP)
-            return moves;
-        return moves;
+    if (checkers & (checkers - 1))
+        return;
+    // In single check every other piece must capture the checker or block its line.
+    uint64_t evasionMask = ~0ULL;
+    if (checkers)
+        evasionMask = checkers | SQUARES_BETWEEN[kingSq][bitScanForward(checkers)];
+    target &= evasionMask;
+    CheckInfo ci{};
+    if constexpr (Type == QUIET_CHECKS)
+        ci = computeCheckInfo<Us>(board);
+    getPawnMoves<Us, Type>(board, moves, pinned, target, kingSq, ci);
+    if constexpr (Type == QUEEN_PROMOTIONS)
+        return;
+    getPieceMoves<Us, knight, Type>(board, moves, pinned, target, kingSq, ci);
+    getPieceMoves<Us, bishop, Type>(board, moves, pinned, target, kingSq, ci);
+    getPieceMoves<Us, rook, Type>(board, moves, pinned, target, kingSq, ci);
+    getPieceMoves<Us, queen, Type>(board, moves, pinned, target, kingSq, ci);
+    if constexpr (Type == ALL_MOVES || Type == QUIETS) {
+        if (!checkers)
+            getCastlingMoves<Us>(board, moves, attacked);
     }
-    uint64_t knights = board->getPiecesByColor(knight, pl);
-    getKnightMoves(board, moves, knights, pinned, own, pl, allowed);
-    getPawnMoves(board, moves, pawns, pinned, board->occupiedBB, opp, pl, allowed);
-    getBishopMoves(board, moves, diagOwn, pinned, own, opp, pl, allowed);
-    getRookMoves(board, moves, orthoOwn, pinned, own, opp, pl, allowed);
-    getCastlingMoves(board, moves, kingSq, att, pl);
-    if (board->enPassantSquare != EMPTYSQ) {
-        uint64_t epPawns = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-        uint64_t unpinned = epPawns & ~pinned;
-        while (unpinned) {
-            int pos = popLeastSignificantBit(&unpinned);
-            Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false };
-            board->makeMoveNoUpdate(mv);
-            if (board->isCheck(pl))
-                board->undoNoUpdate(mv);
-            else {
-                board->undoNoUpdate(mv);
-                moves.push_back(mv);
+    if constexpr (Type != QUIETS && Type != QUIET_CHECKS) {
+        Square ep = board->enPassantSquare;
+        if (ep != EMPTYSQ && (evasionMask & (S_TO_BB[ep] | shiftBitboard(S_TO_BB[ep], Down)))) {
+            uint64_t captured = shiftBitboard(S_TO_BB[ep], Down);
+            uint64_t epPawns = theirPawnAttacks[ep] & board->getPiecesByColor(pawn, Us);
+            while (epPawns) {
+                int pos = popLeastSignificantBit(&epPawns);
+                // En passant empties two squares on the capturing rank at once, which the pin
+                // mask cannot see, so x-ray the king against the occupancy after the capture.
+                uint64_t after = (occ ^ S_TO_BB[pos] ^ captured) | S_TO_BB[ep];
+                if ((getRookAttacks(kingSq, after) & orthoOpp) == 0 && (getBishopAttacks(kingSq, after) & diagOpp) == 0)
+                    moves.push_back(PackedMove(static_cast<Square>(pos), ep, FLAG_ENPASSANT));
             }
         }
-        uint64_t pinPawns = epPawns & pinned & LINE[board->enPassantSquare][kingSq];
-        if (pinPawns) {
-            int pos = popLeastSignificantBit(&pinPawns);
-            moves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false });
-        }
     }
-    return moves;
 }
 
-std::vector<Move> MoveGenerator::generateCaptures(ChessBoard* board) {
-    std::vector<Move> moves;
-    Color pl = board->sideToMove;
-    Color op = reverseColor(pl);
-    uint64_t own = board->colorBitboards[pl];
-    uint64_t opp = board->colorBitboards[op];
-    uint64_t pawns = board->getPiecesByColor(pawn, pl);
-    uint64_t allowed = opp;
-    uint64_t orthoOwn = board->getPiecesByColor(rook, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t diagOwn = board->getPiecesByColor(bishop, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t orthoOpp = board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op);
-    uint64_t diagOpp = board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op);
-    uint64_t att = board->getAllAttacks(op, board->occupiedBB, orthoOpp, diagOpp);
-    Square kingSq = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, pl)));
-    getKingMoves(board, moves, kingSq, att | ~allowed, own, pl);
-    uint64_t checks = 0;
-    if (pl == WHITE)
-        checks |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
+template<GenType Type>
+static void generateForSide(const ChessBoard* board, MoveList& moves) {
+    if (board->sideToMove == WHITE)
+        MoveGenerator::generateAll<WHITE, Type>(board, moves);
     else
-        checks |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-    checks |= (knightAttacks(kingSq) & board->getPiecesByColor(knight, op));
-    uint64_t cand = (getBishopAttacks(kingSq, board->colorBitboards[op]) & diagOpp);
-    cand |= (getRookAttacks(kingSq, board->colorBitboards[op]) & orthoOpp);
-    uint64_t pinned = 0;
-    while (cand) {
-        int pos = popLeastSignificantBit(&cand);
-        uint64_t between = SQUARES_BETWEEN[kingSq][pos] & own;
-        if (between == 0)
-            checks ^= S_TO_BB[pos];
-        else if (between && ((between & (between - 1)) == 0))
-            pinned ^= between;
-    }
-    int numChecks = popCount(checks);
-    if (numChecks == 2)
-        return moves;
-    else if (numChecks == 1) {
-        Square chk = static_cast<Square>(bitScanForward(checks));
-        Piece chkPiece = board->squareArray[chk];
-        Square epShift = board->enPassantSquare + static_cast<Square>(PAWN_PUSH_DIRECTION[op]);
-        if (chk == epShift && (chkPiece == wP || chkPiece == bP)) {
-            uint64_t pawnsCap = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-            uint64_t unpinned = pawnsCap & ~pinned;
-            while (unpinned) {
-                int pos = popLeastSignificantBit(&unpinned);
-                Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], chkPiece, pl, board->squareArray[static_cast<Square>(pos)], false };
-                board->makeMove(mv);
-                if (board->isCheck(pl))
-                    board->undo();
-                else {
-                    board->undo();
-                    moves.push_back(mv);
-                }
-            }
-            uint64_t pinPawns = pawnsCap & pinned & LINE[board->enPassantSquare][kingSq];
-            if (pinPawns) {
-                int pos = popLeastSignificantBit(&pinPawns);
-                moves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false });
-            }
-        }
-        uint64_t possCapt = 0;
-        if (pl == WHITE) {
-            possCapt |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[wN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
-        } else {
-            possCapt |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[bN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
-        }
-        while (possCapt) {
-            int pos = popLeastSignificantBit(&possCapt);
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), S_TO_BB[kingSq], pl);
-        }
-        if (chkPiece == bN || chkPiece == wN)
-            return moves;
-        else if (chkPiece == bP || chkPiece == wP)
-            return moves;
-        return moves;
+        MoveGenerator::generateAll<BLACK, Type>(board, moves);
+}
+
+MoveList MoveGenerator::generateMoves(const ChessBoard* board, GenType type) {
+    MoveList moves;
+    switch (type) {
+        case ALL_MOVES:
+            generateForSide<ALL_MOVES>(board, moves);
+            break;
+        case CAPTURES:
+            generateForSide<CAPTURES>(board, moves);
+            break;
+        case QUIETS:
+            generateForSide<QUIETS>(board, moves);
+            break;
+        case EVASIONS:
+            generateForSide<EVASIONS>(board, moves);
+            break;
+        case QUIET_CHECKS:
+            generateForSide<QUIET_CHECKS>(board, moves);
+            break;
+        case QUEEN_PROMOTIONS:
+            generateForSide<QUEEN_PROMOTIONS>(board, moves);
+            break;
     }
     return moves;
 }
 
-std::vector<Move> MoveGenerator::generateCaptures(ChessBoard* board) {
-    std::vector<Move> moves;
+MoveList MoveGenerator::generateLegalMoves(const ChessBoard* board) {
+    return generateMoves(board, ALL_MOVES);
+}
+
+MoveList MoveGenerator::generateQuiets(const ChessBoard* board) {
+    return generateMoves(board, QUIETS);
+}
+
+MoveList MoveGenerator::generateCaptures(const ChessBoard* board) {
+    return generateTactical(board, TACTICAL_CAPTURES);
+}
+
+// The single tactical generator used by quiescence search. Every move it returns is
+// meant to be searched; each mode is an extra compile-time instantiation appended to
+// the same list, never a superset that the caller has to filter.
+MoveList MoveGenerator::generateTactical(const ChessBoard* board, int mode) {
+    MoveList moves;
+    generateForSide<CAPTURES>(board, moves);
+    if (mode & TACTICAL_PROMOTIONS)
+        generateForSide<QUEEN_PROMOTIONS>(board, moves);
+    if (mode & TACTICAL_CHECKS)
+        generateForSide<QUIET_CHECKS>(board, moves);
+    return moves;
+}
+
+uint64_t MoveGenerator::attackersTo(const ChessBoard* board, Square sq, uint64_t occ, Color by) {
+    Color defender = reverseColor(by);
+    uint64_t ortho = board->getPiecesByColor(rook, by) | board->getPiecesByColor(queen, by);
+    uint64_t diag = board->getPiecesByColor(bishop, by) | board->getPiecesByColor(queen, by);
+    uint64_t attackers = colorToPawnLookup[defender][sq] & board->getPiecesByColor(pawn, by);
+    attackers |= knightAttacks(sq) & board->getPiecesByColor(knight, by);
+    attackers |= kingAttacks(sq) & board->getPiecesByColor(king, by);
+    attackers |= getBishopAttacks(sq, occ) & diag;
+    attackers |= getRookAttacks(sq, occ) & ortho;
+    return attackers & occ;
+}
+
+// Validates a move that did not come from the generator for this position (hash and
+// killer moves) without generating anything. Only valid when the side to move is not
+// in check; in check the search generates evasions in full instead.
+bool MoveGenerator::isLegalMove(const ChessBoard* board, PackedMove mv) {
+    if (mv.isNull())
+        return false;
     Color pl = board->sideToMove;
     Color op = reverseColor(pl);
-    uint64_t own = board->colorBitboards[pl];
-    uint64_t opp = board->colorBitboards[op];
-    uint64_t pawns = board->getPiecesByColor(pawn, pl);
-    uint64_t allowed = opp;
-    uint64_t orthoOwn = board->getPiecesByColor(rook, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t diagOwn = board->getPiecesByColor(bishop, pl) | board->getPiecesByColor(queen, pl);
-    uint64_t orthoOpp = board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op);
-    uint64_t diagOpp = board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op);
-    uint64_t att = board->getAllAttacks(op, board->occupiedBB, orthoOpp, diagOpp);
+    Square from = mv.from();
+    Square to = mv.to();
+    Piece pc = board->squareArray[from];
+    Piece target = board->squareArray[to];
+    if (pc == EMPTY || getPieceColor(pc) != pl)
+        return false;
+    if (target != EMPTY && getPieceColor(target) == pl)
+        return false;
+    uint16_t flags = mv.flags();
+    uint64_t occ = board->occupiedBB;
     Square kingSq = static_cast<Square>(bitScanForward(board->getPiecesByColor(king, pl)));
-    getKingMoves(board, moves, kingSq, att | ~allowed, own, pl);
-    uint64_t checks = 0;
-    if (pl == WHITE)
-        checks |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
-    else
-        checks |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-    checks |= (knightAttacks(kingSq) & board->getPiecesByColor(knight, op));
-    uint64_t cand = (getBishopAttacks(kingSq, board->colorBitboards[op]) & diagOpp);
-    cand |= (getRookAttacks(kingSq, board->colorBitboards[op]) & orthoOpp);
-    uint64_t pinned = 0;
-    while (cand) {
-        int pos = popLeastSignificantBit(&cand);
-        uint64_t between = SQUARES_BETWEEN[kingSq][pos] & own;
-        if (between == 0)
-            checks ^= S_TO_BB[pos];
-        else if (between && ((between & (between - 1)) == 0))
-            pinned ^= between;
-    }
-    int numChecks = popCount(checks);
-    if (numChecks == 2)
-        return moves;
-    else if (numChecks == 1) {
-        Square chk = static_cast<Square>(bitScanForward(checks));
-        Piece chkPiece = board->squareArray[chk];
-        Square epShift = board->enPassantSquare + static_cast<Square>(PAWN_PUSH_DIRECTION[op]);
-        if (chk == epShift && (chkPiece == wP || chkPiece == bP)) {
-            uint64_t pawnsCap = colorToPawnLookup[op][board->enPassantSquare] & pawns;
-            uint64_t unpinned = pawnsCap & ~pinned;
-            while (unpinned) {
-                int pos = popLeastSignificantBit(&unpinned);
-                Move mv { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], chkPiece, pl, board->squareArray[static_cast<Square>(pos)], false };
-                board->makeMove(mv);
-                if (board->isCheck(pl))
-                    board->undo();
-                else {
-                    board->undo();
-                    moves.push_back(mv);
-                }
-            }
-            uint64_t pinPawns = pawnsCap & pinned & LINE[board->enPassantSquare][kingSq];
-            if (pinPawns) {
-                int pos = popLeastSignificantBit(&pinPawns);
-                moves.push_back(Move { static_cast<Square>(pos), board->enPassantSquare, ENPASSANT, board->squareArray[static_cast<Square>(pos)], board->squareArray[board->enPassantSquare], pl, board->squareArray[static_cast<Square>(pos)], false });
-            }
+    if (flags == FLAG_KCASTLE || flags == FLAG_QCASTLE) {
+        if (pc != getCP(pl, king))
+            return false;
+        uint64_t orthoOpp = board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op);
+        uint64_t diagOpp = board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op);
+        MoveList castles;
+        uint64_t attacked = allAttacks(board, op, occ, orthoOpp, diagOpp);
+        if (pl == WHITE)
+            getCastlingMoves<WHITE>(board, castles, attacked);
+        else
+            getCastlingMoves<BLACK>(board, castles, attacked);
+        for (PackedMove castle : castles) {
+            if (castle == mv)
+                return true;
         }
-        uint64_t possCapt = 0;
-        if (pl == WHITE) {
-            possCapt |= (BLACK_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[wP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[wN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
+        return false;
+    }
+    if (flags == FLAG_ENPASSANT) {
+        if (pc != getCP(pl, pawn) || to != board->enPassantSquare || (colorToPawnLookup[pl][from] & S_TO_BB[to]) == 0)
+            return false;
+    } else if (mv.isCapture() != (target != EMPTY)) {
+        return false;
+    }
+    if (pc == getCP(pl, king))
+        return !mv.isPromotion() && (kingAttacks(from) & S_TO_BB[to]) != 0
+            && attackersTo(board, to, occ ^ S_TO_BB[from], op) == 0;
+    uint64_t reach = 0;
+    if (pc == getCP(pl, pawn)) {
+        bool lastRank = (S_TO_BB[to] & (RANK_MASKS[R1] | RANK_MASKS[R8])) != 0;
+        if (lastRank != mv.isPromotion())
+            return false;
+        if (flags == FLAG_ENPASSANT || target != EMPTY) {
+            reach = colorToPawnLookup[pl][from];
         } else {
-            possCapt |= (WHITE_PAWN_ATTACKS_SQUARE_LOOKUP[kingSq] & board->pieceBitboards[bP]);
-            possCapt |= (knightAttacks(kingSq) & board->pieceBitboards[bN]);
-            possCapt |= (getBishopAttacks(kingSq, board->occupiedBB) & diagOwn);
-            possCapt |= (getRookAttacks(kingSq, board->occupiedBB) & orthoOwn);
-            possCapt &= ~pinned;
+            reach = shiftBitboard(S_TO_BB[from], PAWN_PUSH_DIRECTION[pl]) & ~occ;
+            if (reach && (S_TO_BB[from] & RANK_MASKS[STARTING_RANK[pl]]))
+                reach |= shiftBitboard(S_TO_BB[from], PAWN_PUSH_DIRECTION[pl]*2) & ~occ;
         }
-        while (possCapt) {
-            int pos = popLeastSignificantBit(&possCapt);
-            genMovesFromLocations(board, moves, static_cast<Square>(pos), S_TO_BB[kingSq], pl);
-        }
-        if (chkPiece == bN || chkPiece == wN)
-            return moves;
-        else if (chkPiece == bP || chkPiece == wP)
-            return moves;
-        return moves;
+    } else {
+        if (mv.isPromotion())
+            return false;
+        if (pc == getCP(pl, knight))
+            reach = knightAttacks(from);
+        else if (pc == getCP(pl, bishop))
+            reach = getBishopAttacks(from, occ);
+        else if (pc == getCP(pl, rook))
+            reach = getRookAttacks(from, occ);
+        else
+            reach = getBishopAttacks(from, occ) | getRookAttacks(from, occ);
     }
-    return moves;
+    if ((reach & S_TO_BB[to]) == 0)
+        return false;
+    // Not in check, so the only way to expose the king is a discovered slider attack.
+    uint64_t removed = S_TO_BB[to];
+    uint64_t after = (occ ^ S_TO_BB[from]) | S_TO_BB[to];
+    if (flags == FLAG_ENPASSANT) {
+        removed = S_TO_BB[to + PAWN_PUSH_DIRECTION[op]];
+        after ^= removed;
+    }
+    uint64_t orthoOpp = (board->getPiecesByColor(rook, op) | board->getPiecesByColor(queen, op)) & ~removed;
+    uint64_t diagOpp = (board->getPiecesByColor(bishop, op) | board->getPiecesByColor(queen, op)) & ~removed;
+    return (getRookAttacks(kingSq, after) & orthoOpp) == 0 && (getBishopAttacks(kingSq, after) & diagOpp) == 0;
 }
 
 } // namespace Chess
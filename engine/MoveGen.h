@@ -1,31 +1,56 @@
 #ifndef MOVEGEN_H
 #define MOVEGEN_H
 
-#include <vector>
+#include <array>
 #include "Board.h"
 #include "Move.h"
+#include "MoveList.h"
 
 namespace Chess {
 
+// EVASIONS is only meaningful when the side to move is in check; QUIET_CHECKS only
+// when it is not. ALL_MOVES, CAPTURES and QUIETS handle both cases themselves.
+// QUEEN_PROMOTIONS is the non-capturing queen promotions only.
+enum GenType { ALL_MOVES, CAPTURES, QUIETS, EVASIONS, QUIET_CHECKS, QUEEN_PROMOTIONS };
+
+// Tactical generation always produces captures, capture-promotions and en passant;
+// the flags add non-capturing queen promotions and quiet checks on top.
+enum TacticalMode { TACTICAL_CAPTURES = 0, TACTICAL_PROMOTIONS = 1, TACTICAL_CHECKS = 2 };
+
+// Squares from which each piece type would attack the opposing king, and own pieces
+// whose move would uncover a slider on it. Only filled in for QUIET_CHECKS.
+struct CheckInfo {
+    std::array<uint64_t, 6> checkSquares;
+    uint64_t discoverers;
+    Square theirKing;
+};
+
 class MoveGenerator {
 public:
-    static int countPins(ChessBoard* board, Color opp, uint64_t occ, Square kingPos);
-    static uint64_t allAttacks(ChessBoard* board, Color opp, uint64_t occ, uint64_t ortho, uint64_t diag);
+    static int countPins(const ChessBoard* board, Color opp, uint64_t occ, Square kingPos);
+    static uint64_t allAttacks(const ChessBoard* board, Color opp, uint64_t occ, uint64_t ortho, uint64_t diag);
     static uint64_t allPawnAttacks(uint64_t pawns, Color c);
     static uint64_t kingAttacks(Square sq);
     static uint64_t knightAttacks(Square sq);
     static uint64_t getBishopAttacks(Square sq, uint64_t blockers);
     static uint64_t getRookAttacks(Square sq, uint64_t blockers);
-    static void genMovesFromLocations(ChessBoard* board, std::vector<Move>& moves, Square origin, uint64_t locs, Color c);
-    static void getKingMoves(ChessBoard* board, std::vector<Move>& moves, Square kingSq, uint64_t attacked, uint64_t own, Color c);
-    static void getKnightMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t knights, uint64_t pinned, uint64_t own, Color c, uint64_t allowed);
-    static void getPawnMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t pawns, uint64_t pinned, uint64_t occ, uint64_t opp, Color c, uint64_t allowed);
-    static void getBishopMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t bishops, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed);
-    static void getRookMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t rooks, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed);
-    static void getQueenMoves(ChessBoard* board, std::vector<Move>& moves, uint64_t queens, uint64_t pinned, uint64_t own, uint64_t opp, Color c, uint64_t allowed);
-    static void getCastlingMoves(ChessBoard* board, std::vector<Move>& moves, Square kingSq, uint64_t attacked, Color c);
-    static std::vector<Move> generateLegalMoves(ChessBoard* board);
-    static std::vector<Move> generateCaptures(ChessBoard* board);
+    template<GenType Type>
+    static void genMovesFromLocations(const ChessBoard* board, MoveList& moves, Square origin, uint64_t locs);
+    template<Color Us, GenType Type>
+    static void getPawnMoves(const ChessBoard* board, MoveList& moves, uint64_t pinned, uint64_t target, Square kingSq, const CheckInfo& ci);
+    template<Color Us, PieceType Pt, GenType Type>
+    static void getPieceMoves(const ChessBoard* board, MoveList& moves, uint64_t pinned, uint64_t target, Square kingSq, const CheckInfo& ci);
+    template<Color Us>
+    static void getCastlingMoves(const ChessBoard* board, MoveList& moves, uint64_t attacked);
+    template<Color Us, GenType Type>
+    static void generateAll(const ChessBoard* board, MoveList& moves);
+    static uint64_t attackersTo(const ChessBoard* board, Square sq, uint64_t occ, Color by);
+    static bool isLegalMove(const ChessBoard* board, PackedMove mv);
+    static MoveList generateMoves(const ChessBoard* board, GenType type);
+    static MoveList generateLegalMoves(const ChessBoard* board);
+    static MoveList generateQuiets(const ChessBoard* board);
+    static MoveList generateCaptures(const ChessBoard* board);
+    static MoveList generateTactical(const ChessBoard* board, int mode);
 };
 
 } // namespace Chess
@@ -0,0 +1,52 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "Move.h"
+
+namespace Chess {
+
+const int MAX_MOVES = 256;
+
+#ifdef VECTOR_MOVELIST
+// Heap-backed version of the same interface, which allocates at every node the way the
+// old std::vector move lists did. Only there so "bench" can compare the two builds.
+struct MoveList {
+    std::vector<PackedMove> moves;
+
+    void push_back(PackedMove mv) { moves.push_back(mv); }
+    size_t size() const { return moves.size(); }
+    bool empty() const { return moves.empty(); }
+    void clear() { moves.clear(); }
+    PackedMove& operator[](size_t i) { return moves[i]; }
+    const PackedMove& operator[](size_t i) const { return moves[i]; }
+    PackedMove* begin() { return moves.data(); }
+    PackedMove* end() { return moves.data() + moves.size(); }
+    const PackedMove* begin() const { return moves.data(); }
+    const PackedMove* end() const { return moves.data() + moves.size(); }
+};
+#else
+// Fixed-capacity move buffer that lives on the stack, so generating moves at a node
+// never touches the heap. No legal chess position has more than 218 moves.
+struct MoveList {
+    std::array<PackedMove, MAX_MOVES> moves;
+    size_t count = 0;
+
+    void push_back(PackedMove mv) { moves[count++] = mv; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+    PackedMove& operator[](size_t i) { return moves[i]; }
+    const PackedMove& operator[](size_t i) const { return moves[i]; }
+    PackedMove* begin() { return moves.data(); }
+    PackedMove* end() { return moves.data() + count; }
+    const PackedMove* begin() const { return moves.data(); }
+    const PackedMove* end() const { return moves.data() + count; }
+};
+#endif
+
+} // namespace Chess
+
+#endif // MOVELIST_H
@@ -0,0 +1,139 @@
+#include "MovePicker.h"
+#include "MoveGen.h"
+
+namespace Chess {
+
+// Indexed by PieceType: pawn, bishop, knight, rook, queen, king.
+static const std::array<int, 6> MVV_LVA_VALUE = { 1, 3, 3, 5, 9, 20 };
+static const int CAPTURE_BASE = 1 << 24;
+static const int PROMOTION_BONUS = 1 << 20;
+
+static int pieceTypeIndex(Piece p) {
+    return int(p) % colorIndexOffset;
+}
+
+MovePicker::MovePicker(ChessBoard* board, PackedMove ttMove, PackedMove killer1, PackedMove killer2,
+                       const std::array<std::array<int, 64>, 64>& history, bool inCheck)
+    : board(board), ttMove(ttMove), killers{ killer1, killer2 }, history(history), current(0) {
+    if (inCheck)
+        stage = GEN_EVASIONS;
+    else if (MoveGenerator::isLegalMove(board, ttMove))
+        stage = TT_MOVE_STAGE;
+    else {
+        this->ttMove = NULL_MOVE;
+        stage = GEN_CAPTURES;
+    }
+}
+
+bool MovePicker::isSpecial(PackedMove mv) const {
+    return mv == ttMove || mv == killers[0] || mv == killers[1];
+}
+
+void MovePicker::scoreCaptures() {
+    for (size_t i = 0; i < moves.size(); i++) {
+        PackedMove mv = moves[i];
+        int victim = mv.flags() == FLAG_ENPASSANT ? 0 : pieceTypeIndex(board->squareArray[mv.to()]);
+        int attacker = pieceTypeIndex(board->squareArray[mv.from()]);
+        scores[i] = MVV_LVA_VALUE[victim] * 16 - MVV_LVA_VALUE[attacker];
+        if (mv.isPromotion())
+            scores[i] += MVV_LVA_VALUE[int(mv.promotionType())] * 16;
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    for (size_t i = 0; i < moves.size(); i++) {
+        PackedMove mv = moves[i];
+        scores[i] = history[mv.from()][mv.to()];
+        if (mv.isPromotion())
+            scores[i] += PROMOTION_BONUS * MVV_LVA_VALUE[int(mv.promotionType())];
+    }
+}
+
+void MovePicker::scoreEvasions() {
+    for (size_t i = 0; i < moves.size(); i++) {
+        PackedMove mv = moves[i];
+        if (mv == ttMove)
+            scores[i] = CAPTURE_BASE * 2;
+        else if (mv.isCapture())
+            scores[i] = CAPTURE_BASE + MVV_LVA_VALUE[mv.flags() == FLAG_ENPASSANT ? 0 : pieceTypeIndex(board->squareArray[mv.to()])] * 16
+                      - MVV_LVA_VALUE[pieceTypeIndex(board->squareArray[mv.from()])];
+        else
+            scores[i] = history[mv.from()][mv.to()];
+    }
+}
+
+// One step of selection sort: cut-nodes usually stop after a move or two, so sorting
+// the whole list up front would mostly be wasted.
+PackedMove MovePicker::pickBest() {
+    size_t best = current;
+    for (size_t i = current + 1; i < moves.size(); i++) {
+        if (scores[i] > scores[best])
+            best = i;
+    }
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+PackedMove MovePicker::nextMove() {
+    while (true) {
+        switch (stage) {
+            case TT_MOVE_STAGE:
+                stage = GEN_CAPTURES;
+                return ttMove;
+            case GEN_CAPTURES:
+                moves = MoveGenerator::generateMoves(board, CAPTURES);
+                scoreCaptures();
+                current = 0;
+                stage = CAPTURE_MOVES;
+                break;
+            case CAPTURE_MOVES:
+                while (current < moves.size()) {
+                    PackedMove mv = pickBest();
+                    if (mv != ttMove)
+                        return mv;
+                }
+                stage = FIRST_KILLER;
+                break;
+            case FIRST_KILLER:
+                stage = SECOND_KILLER;
+                if (killers[0] != ttMove && !killers[0].isCapture() && MoveGenerator::isLegalMove(board, killers[0]))
+                    return killers[0];
+                break;
+            case SECOND_KILLER:
+                stage = GEN_QUIETS;
+                if (killers[1] != ttMove && killers[1] != killers[0] && !killers[1].isCapture() && MoveGenerator::isLegalMove(board, killers[1]))
+                    return killers[1];
+                break;
+            case GEN_QUIETS:
+                moves = MoveGenerator::generateMoves(board, QUIETS);
+                scoreQuiets();
+                current = 0;
+                stage = QUIET_MOVES;
+                break;
+            case QUIET_MOVES:
+                while (current < moves.size()) {
+                    PackedMove mv = pickBest();
+                    if (!isSpecial(mv))
+                        return mv;
+                }
+                stage = DONE_STAGE;
+                break;
+            case GEN_EVASIONS:
+                moves = MoveGenerator::generateMoves(board, EVASIONS);
+                scoreEvasions();
+                current = 0;
+                stage = EVASION_MOVES;
+                break;
+            case EVASION_MOVES:
+                if (current < moves.size())
+                    return pickBest();
+                stage = DONE_STAGE;
+                break;
+            case DONE_STAGE:
+                return NULL_MOVE;
+        }
+    }
+}
+
+} // namespace Chess
@@ -0,0 +1,52 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include <array>
+#include "Board.h"
+#include "Move.h"
+#include "MoveList.h"
+
+namespace Chess {
+
+enum PickerStage {
+    TT_MOVE_STAGE,
+    GEN_CAPTURES,
+    CAPTURE_MOVES,
+    FIRST_KILLER,
+    SECOND_KILLER,
+    GEN_QUIETS,
+    QUIET_MOVES,
+    GEN_EVASIONS,
+    EVASION_MOVES,
+    DONE_STAGE
+};
+
+// Hands out moves one at a time in the order the search wants them: hash move, captures
+// by MVV-LVA, killers, then quiets by history. Each stage is only generated once the
+// previous one is used up, so a cutoff on an early move skips the rest of the work.
+class MovePicker {
+public:
+    MovePicker(ChessBoard* board, PackedMove ttMove, PackedMove killer1, PackedMove killer2,
+               const std::array<std::array<int, 64>, 64>& history, bool inCheck);
+    PackedMove nextMove();
+
+private:
+    ChessBoard* board;
+    PackedMove ttMove;
+    std::array<PackedMove, 2> killers;
+    const std::array<std::array<int, 64>, 64>& history;
+    PickerStage stage;
+    MoveList moves;
+    std::array<int, MAX_MOVES> scores;
+    size_t current;
+
+    void scoreCaptures();
+    void scoreQuiets();
+    void scoreEvasions();
+    PackedMove pickBest();
+    bool isSpecial(PackedMove mv) const;
+};
+
+} // namespace Chess
+
+#endif // MOVEPICKER_H
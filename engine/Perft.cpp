@@ -0,0 +1,126 @@
+#include "Perft.h"
+#include "MoveGen.h"
+#include <atomic>
+#include <thread>
+
+namespace Chess {
+
+uint64_t perft(ChessBoard* board, int depth) {
+    if (depth == 0)
+        return 1;
+    MoveList moves = MoveGenerator::generateLegalMoves(board);
+    // Bulk counting: the legal move count is exactly the number of leaves one ply down.
+    if (depth == 1)
+        return moves.size();
+    uint64_t nodes = 0;
+    for (PackedMove mv : moves) {
+        board->executeMove(mv);
+        nodes += perft(board, depth - 1);
+        board->revertLastMove();
+    }
+    return nodes;
+}
+
+void initPerftTable(PerftTable* table, int mb) {
+    table->tableSize = static_cast<uint64_t>(mb) * 1024 * 1024 / sizeof(PerftEntry);
+    if (table->tableSize == 0)
+        table->tableSize = 1;
+    table->entries.assign(table->tableSize, PerftEntry { 0, 0, 0 });
+    table->probes = 0;
+    table->hits = 0;
+}
+
+uint64_t perftHashed(ChessBoard* board, int depth, PerftTable* table) {
+    if (depth == 0)
+        return 1;
+    if (depth == 1)
+        return MoveGenerator::generateLegalMoves(board).size();
+    // Probe before generating, so a hit costs no move generation at all.
+    uint64_t key = board->zobristHash;
+    PerftEntry& entry = table->entries[(key ^ uint64_t(depth)) % table->tableSize];
+    table->probes++;
+    if (entry.hashValue == key && entry.depth == depth) {
+        table->hits++;
+        return entry.nodes;
+    }
+    MoveList moves = MoveGenerator::generateLegalMoves(board);
+    uint64_t nodes = 0;
+    for (PackedMove mv : moves) {
+        board->executeMove(mv);
+        nodes += perftHashed(board, depth - 1, table);
+        board->revertLastMove();
+    }
+    entry = { key, nodes, depth };
+    return nodes;
+}
+
+std::vector<std::pair<PackedMove, uint64_t>> perftDivide(ChessBoard* board, int depth) {
+    std::vector<std::pair<PackedMove, uint64_t>> counts;
+    if (depth <= 0)
+        return counts;
+    MoveList moves = MoveGenerator::generateLegalMoves(board);
+    for (PackedMove mv : moves) {
+        board->executeMove(mv);
+        counts.push_back({ mv, perft(board, depth - 1) });
+        board->revertLastMove();
+    }
+    return counts;
+}
+
+struct PerftWorkItem {
+    size_t rootIndex;
+    std::vector<PackedMove> path;
+    uint64_t nodes;
+};
+
+ParallelPerftResult perftParallel(const ChessBoard& board, int depth, int threads) {
+    ParallelPerftResult result { 0, std::vector<uint64_t>(threads > 0 ? threads : 1, 0), {} };
+    if (depth <= 0) {
+        result.nodes = 1;
+        return result;
+    }
+    ChessBoard root = board;
+    MoveList rootMoves = MoveGenerator::generateLegalMoves(&root);
+    // With only ~20-40 root moves the subtrees are too uneven to balance well, so deeper
+    // runs are split one ply further into (root move, reply) pairs.
+    std::vector<PerftWorkItem> items;
+    for (size_t i = 0; i < rootMoves.size(); i++) {
+        result.rootCounts.push_back({ rootMoves[i], 0 });
+        if (depth < 3) {
+            items.push_back({ i, { rootMoves[i] }, 0 });
+            continue;
+        }
+        root.executeMove(rootMoves[i]);
+        MoveList replies = MoveGenerator::generateLegalMoves(&root);
+        for (PackedMove reply : replies)
+            items.push_back({ i, { rootMoves[i], reply }, 0 });
+        root.revertLastMove();
+    }
+    std::atomic<size_t> nextItem(0);
+    auto worker = [&](int id) {
+        ChessBoard local = board;
+        uint64_t count = 0;
+        for (size_t i = nextItem++; i < items.size(); i = nextItem++) {
+            PerftWorkItem& item = items[i];
+            for (PackedMove mv : item.path)
+                local.executeMove(mv);
+            item.nodes = perft(&local, depth - int(item.path.size()));
+            for (size_t j = 0; j < item.path.size(); j++)
+                local.revertLastMove();
+            count += item.nodes;
+        }
+        result.threadNodes[id] = count;
+    };
+    std::vector<std::thread> pool;
+    for (size_t id = 0; id < result.threadNodes.size(); id++)
+        pool.emplace_back(worker, int(id));
+    for (std::thread& t : pool)
+        t.join();
+    for (const PerftWorkItem& item : items) {
+        result.rootCounts[item.rootIndex].second += item.nodes;
+        result.nodes += item.nodes;
+    }
+    return result;
+}
+
+} // namespace Chess
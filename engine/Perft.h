@@ -0,0 +1,39 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "Board.h"
+#include "Move.h"
+
+namespace Chess {
+
+struct ParallelPerftResult {
+    uint64_t nodes;
+    std::vector<uint64_t> threadNodes;
+    std::vector<std::pair<PackedMove, uint64_t>> rootCounts;
+};
+
+struct PerftEntry {
+    uint64_t hashValue;
+    uint64_t nodes;
+    int depth;
+};
+
+struct PerftTable {
+    std::vector<PerftEntry> entries;
+    uint64_t tableSize;
+    uint64_t probes;
+    uint64_t hits;
+};
+
+void initPerftTable(PerftTable* table, int megabytes);
+uint64_t perft(ChessBoard* board, int depth);
+uint64_t perftHashed(ChessBoard* board, int depth, PerftTable* table);
+std::vector<std::pair<PackedMove, uint64_t>> perftDivide(ChessBoard* board, int depth);
+ParallelPerftResult perftParallel(const ChessBoard& board, int depth, int threads);
+
+} // namespace Chess
+
+#endif // PERFT_H
@@ -4,33 +4,89 @@
 #include "UCI.h"
 #include "Search.h"
 #include "Board.h"
+#include "Perft.h"
+#include "MoveGen.h"
+#include "Evaluation.h"
+#include "TimeManager.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <thread>
+#include <random>
+#include <memory>
+#include <array>
+#include <algorithm>
 
 namespace Chess {
 
+static const std::vector<std::string> BENCH_POSITIONS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+};
+
+// Every lookup table is generated at compile time; the only startup work left is
+// picking the slider backend for this CPU.
 void initialize() {
-    initializeKingAttacks();
-    initializeKnightAttacks();
-    initializePawnAttacks();
-    initBishopAttacks();
-    initRookAttacks();
-    initSquaresBetween();
-    initLine();
-    initializeSQLookup();
-    initZobrist();
-    initNeighborMasks();
+    initSliderBackend();
 }
 
 void Run(const std::string& command, const std::string& position, int depth) {
-    initializeEverythingExceptTTable();
+    initialize();
     initTransTable(256);
     if (command == "perft") {
-        // RunPerfTests(position, depth); // Not implemented in this translation.
+        RunPerfTests(position, depth);
+    }
+    if (command == "bench") {
+        RunBench(depth);
+    }
+    if (command == "qbench") {
+        RunQSearchBench(depth);
+    }
+    if (command == "sliderbench") {
+        RunSliderBench(depth);
+    }
+    if (command == "pawnbench") {
+        RunPawnBench(depth);
+    }
+    if (command == "evalbench") {
+        RunEvalBench(depth);
+    }
+    if (command == "ttbench") {
+        RunTTBench(depth);
+    }
+    if (command == "smpbench") {
+        RunSMPBench(depth);
+    }
+    if (command == "divide") {
+        RunPerftDivide(position, depth);
+    }
+    if (command.find("pperft") != std::string::npos) {
+        std::istringstream iss(command);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (iss >> token)
+            tokens.push_back(token);
+        int threads = int(std::thread::hardware_concurrency());
+        if (tokens.size() >= 2)
+            threads = std::stoi(tokens[1]);
+        RunParallelPerft(position, depth, threads > 0 ? threads : 1);
+    }
+    if (command.find("hperft") != std::string::npos) {
+        std::istringstream iss(command);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (iss >> token)
+            tokens.push_back(token);
+        int megabytes = 256;
+        if (tokens.size() >= 2)
+            megabytes = std::stoi(tokens[1]);
+        RunHashedPerft(position, depth, megabytes);
     }
     if (command == "search") {
         RunSearch(position, depth);
@@ -38,6 +94,20 @@ void Run(const std::string& command, const std::string& position, int depth) {
     if (command == "selfplay") {
         RunSelfPlay(position, depth);
     }
+    if (command.find("timegame") != std::string::npos) {
+        std::istringstream iss(command);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (iss >> token)
+            tokens.push_back(token);
+        int64_t baseTime = 10000;
+        int64_t increment = 100;
+        if (tokens.size() >= 2)
+            baseTime = std::stoll(tokens[1]);
+        if (tokens.size() >= 3)
+            increment = std::stoll(tokens[2]);
+        RunTimeGame(position, baseTime, increment);
+    }
     if (command.find("play") != std::string::npos) {
         std::istringstream iss(command);
         std::vector<std::string> tokens;
@@ -53,7 +123,391 @@ void Run(const std::string& command, const std::string& position, int depth) {
     }
 }
 
+void RunPerfTests(const std::string& position, int depth) {
+    ChessBoard board;
+    if (position == "startpos")
+        board.initializeStartingPosition();
+    else
+        board.initializeFEN(position);
+    for (int i = 1; i <= depth; i++) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(&board, i);
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t nps = elapsed > 0 ? nodes * 1000000 / elapsed : 0;
+        std::cout << "Depth " << i << ": " << nodes << " nodes, " << elapsed / 1000 << " ms, " << nps << " nps" << std::endl;
+    }
+}
+
+void RunPerftDivide(const std::string& position, int depth) {
+    ChessBoard board;
+    if (position == "startpos")
+        board.initializeStartingPosition();
+    else
+        board.initializeFEN(position);
+    auto start = std::chrono::steady_clock::now();
+    auto counts = perftDivide(&board, depth);
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    uint64_t total = 0;
+    for (const auto& entry : counts) {
+        std::cout << entry.first.toUCI() << ": " << entry.second << std::endl;
+        total += entry.second;
+    }
+    uint64_t nps = elapsed > 0 ? total * 1000000 / elapsed : 0;
+    std::cout << std::endl << "Moves: " << counts.size() << std::endl;
+    std::cout << "Nodes: " << total << ", " << elapsed / 1000 << " ms, " << nps << " nps" << std::endl;
+}
+
+void RunParallelPerft(const std::string& position, int depth, int threads) {
+    ChessBoard board;
+    if (position == "startpos")
+        board.initializeStartingPosition();
+    else
+        board.initializeFEN(position);
+    auto start = std::chrono::steady_clock::now();
+    ParallelPerftResult result = perftParallel(board, depth, threads);
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& entry : result.rootCounts)
+        std::cout << entry.first.toUCI() << ": " << entry.second << std::endl;
+    std::cout << std::endl;
+    for (size_t i = 0; i < result.threadNodes.size(); i++)
+        std::cout << "Thread " << i << ": " << result.threadNodes[i] << " nodes" << std::endl;
+    uint64_t nps = elapsed > 0 ? result.nodes * 1000000 / elapsed : 0;
+    std::cout << "Nodes: " << result.nodes << ", " << threads << " threads, " << elapsed / 1000 << " ms, " << nps << " nps" << std::endl;
+}
+
+void RunHashedPerft(const std::string& position, int depth, int megabytes) {
+    ChessBoard board;
+    if (position == "startpos")
+        board.initializeStartingPosition();
+    else
+        board.initializeFEN(position);
+    PerftTable table;
+    initPerftTable(&table, megabytes);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hashedNodes = perftHashed(&board, depth, &table);
+    int64_t hashedTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    double hitRate = table.probes > 0 ? 100.0 * table.hits / table.probes : 0.0;
+    std::cout << "Hashed: " << hashedNodes << " nodes, " << hashedTime / 1000 << " ms, "
+              << table.hits << "/" << table.probes << " hits (" << hitRate << "%), "
+              << megabytes << " MB table" << std::endl;
+    start = std::chrono::steady_clock::now();
+    uint64_t plainNodes = perft(&board, depth);
+    int64_t plainTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Plain:  " << plainNodes << " nodes, " << plainTime / 1000 << " ms" << std::endl;
+    if (hashedNodes != plainNodes)
+        std::cout << "Mismatch between hashed and plain perft!" << std::endl;
+    if (hashedTime > 0)
+        std::cout << "Speedup: " << double(plainTime) / double(hashedTime) << "x" << std::endl;
+}
+
+void RunBench(int depth) {
+    auto st = std::make_unique<SearchThread>();
+    uint64_t perftNodes = 0;
+    int64_t perftTime = 0;
+    uint64_t searchNodes = 0;
+    int64_t searchTime = 0;
+    for (const std::string& fen : BENCH_POSITIONS) {
+        ChessBoard board;
+        board.initializeFEN(fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(&board, depth);
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        perftNodes += nodes;
+        perftTime += elapsed;
+        clearTransTable();
+        std::vector<PackedMove> pvLine;
+        uint64_t nodesBefore = st->nodes;
+        start = std::chrono::steady_clock::now();
+        for (int d = 1; d <= depth + 2; d++)
+            principalVariationSearch(st.get(), &board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
+        int64_t searched = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t searchedNodes = st->nodes - nodesBefore;
+        searchNodes += searchedNodes;
+        searchTime += searched;
+        std::cout << fen << std::endl;
+        std::cout << "  perft " << depth << ": " << nodes << " nodes, " << elapsed / 1000 << " ms" << std::endl;
+        std::cout << "  search " << depth + 2 << ": " << searchedNodes << " nodes, " << searched / 1000 << " ms" << std::endl;
+    }
+    std::cout << "Perft:  " << perftNodes << " nodes, " << perftTime / 1000 << " ms, "
+              << (perftTime > 0 ? perftNodes * 1000000 / perftTime : 0) << " nps" << std::endl;
+    std::cout << "Search: " << searchNodes << " nodes, " << searchTime / 1000 << " ms, "
+              << (searchTime > 0 ? searchNodes * 1000000 / searchTime : 0) << " nps" << std::endl;
+}
+
+// Compares the old way of feeding quiescence (full legal generation, then dropping
+// non-captures) against the tactical generator, and reports the qsearch node rate.
+void RunQSearchBench(int iterations) {
+    auto st = std::make_unique<SearchThread>();
+    if (iterations <= 0)
+        iterations = 1;
+    int64_t filteredTime = 0;
+    int64_t tacticalTime = 0;
+    uint64_t qsearchNodes = 0;
+    int64_t qsearchTime = 0;
+    for (const std::string& fen : BENCH_POSITIONS) {
+        ChessBoard board;
+        board.initializeFEN(fen);
+        size_t kept = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations * 1000; i++) {
+            MoveList moves = MoveGenerator::generateLegalMoves(&board);
+            for (PackedMove mv : moves)
+                if (mv.isCapture())
+                    kept++;
+        }
+        int64_t filtered = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        size_t generated = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations * 1000; i++)
+            generated += MoveGenerator::generateTactical(&board, TACTICAL_CAPTURES).size();
+        int64_t tactical = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (kept != generated)
+            std::cout << "Capture count mismatch: " << kept << " filtered, " << generated << " tactical" << std::endl;
+        uint64_t nodesBefore = st->nodes;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            quiescenceSearch(st.get(), &board, 8, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove);
+        int64_t searched = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t nodes = st->nodes - nodesBefore;
+        filteredTime += filtered;
+        tacticalTime += tactical;
+        qsearchNodes += nodes;
+        qsearchTime += searched;
+        std::cout << fen << std::endl;
+        std::cout << "  generate+filter: " << filtered / 1000 << " ms, tactical: " << tactical / 1000 << " ms" << std::endl;
+        std::cout << "  qsearch: " << nodes << " nodes, " << searched / 1000 << " ms" << std::endl;
+    }
+    std::cout << "Generation: filtered " << filteredTime / 1000 << " ms, tactical " << tacticalTime / 1000 << " ms";
+    if (tacticalTime > 0)
+        std::cout << " (" << double(filteredTime) / double(tacticalTime) << "x)";
+    std::cout << std::endl;
+    std::cout << "QSearch: " << qsearchNodes << " nodes, " << qsearchTime / 1000 << " ms, "
+              << (qsearchTime > 0 ? qsearchNodes * 1000000 / qsearchTime : 0) << " nps" << std::endl;
+}
+
+// Reports the pawn table hit rate seen by a search of each bench position, then times
+// pawn evaluation with and without the cache over the positions two plies deep.
+void RunPawnBench(int depth) {
+    auto st = std::make_unique<SearchThread>();
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    std::vector<ChessBoard> leaves;
+    for (const std::string& fen : BENCH_POSITIONS) {
+        ChessBoard board;
+        board.initializeFEN(fen);
+        clearTransTable();
+        clearPawnTable();
+        std::vector<PackedMove> pvLine;
+        for (int d = 1; d <= depth; d++)
+            principalVariationSearch(st.get(), &board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
+        auto [p, h] = pawnTableStats();
+        probes += p;
+        hits += h;
+        std::cout << fen << std::endl;
+        std::cout << "  search " << depth << ": " << p << " pawn probes, "
+                  << (p > 0 ? 100.0 * double(h) / double(p) : 0.0) << "% hits" << std::endl;
+        for (PackedMove mv : MoveGenerator::generateLegalMoves(&board)) {
+            board.makeMove(mv);
+            for (PackedMove reply : MoveGenerator::generateLegalMoves(&board)) {
+                board.makeMove(reply);
+                leaves.push_back(board);
+                board.undo();
+            }
+            board.undo();
+        }
+    }
+    std::cout << "Pawn table: " << probes << " probes, "
+              << (probes > 0 ? 100.0 * double(hits) / double(probes) : 0.0) << "% hits" << std::endl;
+    const int rounds = 100;
+    int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        for (const ChessBoard& leaf : leaves)
+            sink += computePawnEntry(&leaf).score;
+    int64_t uncached = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    clearPawnTable();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        for (ChessBoard& leaf : leaves)
+            evaluatePawns(&leaf, &sink);
+    int64_t cached = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    uint64_t evals = uint64_t(rounds) * leaves.size();
+    std::cout << "Pawn eval over " << leaves.size() << " positions (checksum " << (sink & 0xFFFF) << "): uncached "
+              << double(uncached) / double(evals) << " ns, cached " << double(cached) / double(evals) << " ns";
+    if (cached > 0)
+        std::cout << " (" << double(uncached) / double(cached) << "x)";
+    std::cout << std::endl;
+}
+
+// Eval throughput over every position two plies from the bench positions, next to the
+// cost of rebuilding material and piece-square sums from squareArray, which is what the
+// board's running accumulators replace.
+void RunEvalBench(int iterations) {
+    if (iterations <= 0)
+        iterations = 1;
+    std::vector<ChessBoard> leaves;
+    for (const std::string& fen : BENCH_POSITIONS) {
+        ChessBoard board;
+        board.initializeFEN(fen);
+        for (PackedMove mv : MoveGenerator::generateLegalMoves(&board)) {
+            board.makeMove(mv);
+            for (PackedMove reply : MoveGenerator::generateLegalMoves(&board)) {
+                board.makeMove(reply);
+                leaves.push_back(board);
+                board.undo();
+            }
+            board.undo();
+        }
+    }
+    uint64_t evals = uint64_t(iterations) * leaves.size();
+    int64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (ChessBoard& leaf : leaves) {
+            int material = 0;
+            int psq = 0;
+            for (int sq = 0; sq < 64; sq++) {
+                material += pieceMaterial[leaf.squareArray[sq]];
+                psq += pieceSquareValues[MIDDLEGAME][leaf.squareArray[sq]][sq];
+            }
+            sink += material + psq;
+        }
+    }
+    int64_t scanTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (ChessBoard& leaf : leaves)
+            sink += leaf.material + leaf.psqScore[MIDDLEGAME];
+    int64_t accumulatedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (ChessBoard& leaf : leaves)
+            sink += evaluatePosition(&leaf);
+    int64_t evalTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << leaves.size() << " positions x " << iterations << " (checksum " << (sink & 0xFFFF) << ")" << std::endl;
+    std::cout << "Material+PST: scan " << double(scanTime) / double(evals) << " ns, accumulated "
+              << double(accumulatedTime) / double(evals) << " ns" << std::endl;
+    std::cout << "evaluatePosition: " << double(evalTime) / double(evals) << " ns, "
+              << (evalTime > 0 ? evals * 1000000000 / evalTime : 0) << " evals/s" << std::endl;
+}
+
+// Time to reach the given depth on each bench position with a fresh table, together
+// with the table's hit rate and hashfull, at a few hash sizes.
+void RunTTBench(int depth) {
+    auto st = std::make_unique<SearchThread>();
+    for (int mb : { 16, 256, 1024 }) {
+        initTransTable(mb);
+        int64_t totalTime = 0;
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+        int hashfull = 0;
+        auto clearStart = std::chrono::steady_clock::now();
+        clearTransTable();
+        int64_t clearTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clearStart).count();
+        std::cout << "Hash " << mb << " MB (" << transTable.clusterCount << " clusters), full clear "
+                  << clearTime / 1000 << " ms" << std::endl;
+        for (const std::string& fen : BENCH_POSITIONS) {
+            ChessBoard board;
+            board.initializeFEN(fen);
+            clearTransTable();
+            newSearchGeneration();
+            std::vector<PackedMove> pvLine;
+            auto start = std::chrono::steady_clock::now();
+            for (int d = 1; d <= depth; d++)
+                principalVariationSearch(st.get(), &board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
+            int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            totalTime += elapsed;
+            auto [p, h] = transTableStats();
+            probes += p;
+            hits += h;
+            hashfull += transTableHashfull();
+            std::cout << "  depth " << depth << ": " << elapsed / 1000 << " ms, "
+                      << (p > 0 ? 100.0 * double(h) / double(p) : 0.0)
+                      << "% hits, hashfull " << transTableHashfull() << std::endl;
+        }
+        std::cout << "  total " << totalTime / 1000 << " ms, "
+                  << (probes > 0 ? 100.0 * double(hits) / double(probes) : 0.0) << "% hits, mean hashfull "
+                  << hashfull / int(BENCH_POSITIONS.size()) << std::endl;
+    }
+    initTransTable(256);
+}
+
+// Lazy SMP scaling: time for the main thread to finish the given depth on every bench
+// position, and the node rate summed over all threads, for 1 to 32 threads.
+void RunSMPBench(int depth) {
+    int64_t baseTime = 0;
+    for (int threads : { 1, 2, 4, 8, 16, 32 }) {
+        setSearchThreads(threads);
+        int64_t totalTime = 0;
+        uint64_t totalNodes = 0;
+        for (const std::string& fen : BENCH_POSITIONS) {
+            ChessBoard board;
+            board.initializeFEN(fen);
+            clearTransTable();
+            auto start = std::chrono::steady_clock::now();
+            searchWithTime(&board, 100000000, depth);
+            totalTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            totalNodes += lastSearchNodes();
+        }
+        if (threads == 1)
+            baseTime = totalTime;
+        std::cout << threads << " threads: depth " << depth << " in " << totalTime / 1000 << " ms";
+        if (totalTime > 0)
+            std::cout << " (" << double(baseTime) / double(totalTime) << "x), "
+                      << totalNodes * 1000000 / totalTime << " nps";
+        std::cout << std::endl;
+    }
+    setSearchThreads(1);
+}
+
+// Times raw slider lookups and perft over the bench positions with each attack backend.
+// The PEXT half is skipped on hosts without BMI2.
+void RunSliderBench(int depth) {
+    SliderBackend selected = sliderBackend;
+    std::vector<SliderBackend> backends = {MAGIC_BACKEND};
+    if (cpuHasBmi2())
+        backends.push_back(PEXT_BACKEND);
+    else
+        std::cout << "BMI2 not available, benchmarking magic backend only" << std::endl;
+    size_t tableBytes = sizeof(bishopAttacks) + sizeof(rookAttacks);
+    std::cout << "Magic tables: " << tableBytes / 1024 << " KB, PEXT tables: "
+              << (sizeof(bishopPextAttacks) + sizeof(rookPextAttacks)) / 1024 << " KB" << std::endl;
+    std::mt19937_64 rng(12345);
+    std::vector<uint64_t> occupancies(4096);
+    for (uint64_t& occ : occupancies)
+        occ = rng() & rng();
+    for (SliderBackend backend : backends) {
+        sliderBackend = backend;
+        const char* name = backend == PEXT_BACKEND ? "pext" : "magic";
+        uint64_t sink = 0;
+        const int rounds = 100;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < occupancies.size(); i++) {
+                Square sq = static_cast<Square>(i & 63);
+                sink ^= MoveGenerator::getBishopAttacks(sq, occupancies[i]);
+                sink ^= MoveGenerator::getRookAttacks(sq, occupancies[i]);
+            }
+        }
+        int64_t lookupTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t lookups = uint64_t(rounds) * occupancies.size() * 2;
+        uint64_t perftNodes = 0;
+        start = std::chrono::steady_clock::now();
+        for (const std::string& fen : BENCH_POSITIONS) {
+            ChessBoard board;
+            board.initializeFEN(fen);
+            perftNodes += perft(&board, depth);
+        }
+        int64_t perftTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << double(lookupTime) / double(lookups) << " ns/lookup (checksum " << (sink & 0xFFFF) << "), "
+                  << "perft " << depth << " " << perftNodes << " nodes, " << perftTime / 1000 << " ms, "
+                  << (perftTime > 0 ? perftNodes * 1000000 / perftTime : 0) << " nps" << std::endl;
+    }
+    sliderBackend = selected;
+}
+
 void RunSearch(const std::string& position, int depth) {
+    auto st = std::make_unique<SearchThread>();
     ChessBoard board;
     if (position == "startpos")
         board.initializeStartingPosition();
@@ -61,9 +515,9 @@ void RunSearch(const std::string& position, int depth) {
         board.initializeFEN(position);
     board.printFromBitBoards();
     for (int i = 1; i <= depth; i++) {
-        std::vector<Move> pvLine;
+        std::vector<PackedMove> pvLine;
         std::cout << "Depth " << i << ": ";
-        auto result = pvs(&board, i, i, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine, 100000000, std::chrono::steady_clock::now());
+        auto result = principalVariationSearch(st.get(), &board, i, i, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
         int score = result.first * FACTOR[board.sideToMove];
         bool timeout = result.second;
         if (timeout)
@@ -85,7 +539,7 @@ void RunSearch(const std::string& position, int depth) {
 }
 
 void RunSelfPlay(const std::string& position, int depth) {
-    initializeEverythingExceptTTable();
+    initialize();
     initTransTable(256);
     ChessBoard board;
     if (position == "startpos")
@@ -97,7 +551,7 @@ void RunSelfPlay(const std::string& position, int depth) {
     while (!legalMoves.empty()) {
         board.printFromBitBoards();
         int score = 0;
-        Move bestMove = searchWithTime(&board, 10000);
+        PackedMove bestMove = searchWithTime(&board, 10000);
         board.printFromBitBoards();
         std::cout << "SCORE: " << (score * FACTOR[board.sideToMove]) << std::endl;
         movesPlayed.push_back(bestMove.toUCI());
@@ -110,9 +564,65 @@ void RunSelfPlay(const std::string& position, int depth) {
     }
 }
 
+// Self-play under a real clock: both sides get baseTime ms plus increment per move and
+// think through the same time manager as under UCI. Reports the time used per move
+// against the budget, and any flag fall. Stops at mate, a draw, or 300 plies.
+void RunTimeGame(const std::string& position, int64_t baseTime, int64_t increment) {
+    clearTransTable();
+    ChessBoard board;
+    if (position == "startpos")
+        board.initializeStartingPosition();
+    else
+        board.initializeFEN(position);
+    std::array<int64_t, 2> clock = { baseTime, baseTime };
+    std::array<int64_t, 2> used = { 0, 0 };
+    std::array<int64_t, 2> longest = { 0, 0 };
+    std::array<int64_t, 2> optimumSum = { 0, 0 };
+    std::array<int, 2> moves = { 0, 0 };
+    std::array<bool, 2> flagged = { false, false };
+    std::vector<std::string> movesPlayed;
+    for (int ply = 0; ply < 300; ply++) {
+        if (board.generateLegalMoves().empty() || board.isThreeFoldRep() || board.isInsufficientMaterial())
+            break;
+        Color us = board.sideToMove;
+        TimeControl tc;
+        tc.time = clock[us];
+        tc.inc = increment;
+        TimeBudget budget = allocateTime(tc);
+        clearSearchStop();
+        startSearchClock(budget);
+        auto start = std::chrono::steady_clock::now();
+        PackedMove bestMove = searchWithLimits(&board);
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        clock[us] -= elapsed;
+        if (clock[us] < 0)
+            flagged[us] = true;
+        clock[us] += increment;
+        used[us] += elapsed;
+        longest[us] = std::max(longest[us], elapsed);
+        optimumSum[us] += budget.optimum;
+        moves[us]++;
+        movesPlayed.push_back(bestMove.toUCI());
+        board.makeMove(bestMove);
+    }
+    std::cout << "Moves played: ";
+    for (const auto& m : movesPlayed)
+        std::cout << m << " ";
+    std::cout << std::endl;
+    std::cout << "Time control " << baseTime << "+" << increment << " ms" << std::endl;
+    for (Color c : { WHITE, BLACK }) {
+        if (moves[c] == 0)
+            continue;
+        std::cout << (c == WHITE ? "White" : "Black") << ": " << moves[c] << " moves, "
+                  << used[c] / moves[c] << " ms/move (optimum " << optimumSum[c] / moves[c] << " ms), longest "
+                  << longest[c] << " ms, " << clock[c] << " ms left" << (flagged[c] ? ", LOST ON TIME" : "") << std::endl;
+    }
+}
+
 void RunPlay(const std::string& position, int depth, int player) {
-    initializeEverythingExceptTTable();
+    initialize();
     initTransTable(256);
+    auto st = std::make_unique<SearchThread>();
     ChessBoard board;
     if (position == "startpos")
         board.initializeStartingPosition();
@@ -129,12 +639,12 @@ void RunPlay(const std::string& position, int depth, int player) {
             board.makeMoveFromUCI(moveStr);
             movesPlayed.push_back(moveStr);
         } else {
-            std::vector<Move> pvLine;
+            std::vector<PackedMove> pvLine;
             int score = 0;
             for (int i = 1; i <= depth; i++) {
                 pvLine.clear();
                 std::cout << "Depth " << i << ": ";
-                auto result = pvs(&board, i, i, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine, 100000, std::chrono::steady_clock::now());
+                auto result = principalVariationSearch(st.get(), &board, i, i, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
                 score = result.first;
                 if (score == WIN_VALUE || score == -WIN_VALUE) {
                     std::cout << "Found mate." << std::endl;
@@ -150,7 +660,7 @@ void RunPlay(const std::string& position, int depth, int player) {
                 }
                 std::cout << "]" << std::endl;
             }
-            Move bestMove = pvLine[0];
+            PackedMove bestMove = pvLine[0];
             std::cout << "SCORE: " << (score * FACTOR[board.sideToMove]) << std::endl;
             movesPlayed.push_back(bestMove.toUCI());
             board.makeMove(bestMove);
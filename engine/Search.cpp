@@ -1,168 +1,194 @@
 #include "Search.h"
 #include "Evaluation.h"
 #include "MoveGen.h"
+#include "MovePicker.h"
+#include "TTable.h"
+#include "TimeManager.h"
+#include "UCI.h"
 #include "Constants.h"
 #include "Bitboard.h"
 #include <algorithm>
 #include <iostream>
+#include <string>
 #include <chrono>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 namespace Chess {
 
-struct MoveBonus {
-    Move mv;
-    int bonus;
-};
-
 static const int NULL_MOVE_RED = 3;
-static int nodesExamined = 0;
-static std::array<std::array<Move, 2>, 100> killerMoves;
-static std::array<std::array<std::array<int, 64>, 64>, 100> historyHeuristic;
+// How many times longer than the previous one an iteration is assumed to take.
+static const int64_t ITERATION_GROWTH = 2;
+
+static int searchThreads = 1;
+static std::atomic<bool> helpersStop(false);
+// Raised by "stop" from the UCI thread or by whichever search thread first sees the hard
+// deadline pass; every thread unwinds once it reads it.
+static std::atomic<bool> stopRequested(false);
+// One SearchThread per search thread, index 0 being the thread that called searchWithTime.
+// They outlive a single search so history carries over from move to move.
+static std::vector<std::unique_ptr<SearchThread>> searchPool;
+
+// Each thread reads the clock every clockCheckInterval nodes, rescaled at every poll from
+// its own node rate so that polls land about once a millisecond.
+static const uint64_t MIN_CLOCK_CHECK_INTERVAL = 64;
+static const uint64_t MAX_CLOCK_CHECK_INTERVAL = 1 << 16;
+
+static void pollSearchClock(SearchThread* st) {
+    int64_t elapsed = searchElapsedMs();
+    if (elapsed > searchHardLimit())
+        stopRequested.store(true, std::memory_order_relaxed);
+    uint64_t nodes = st->nodes - st->lastPollNodes;
+    int64_t ms = elapsed - st->lastPollMs;
+    uint64_t interval = ms > 0 ? nodes / uint64_t(ms) : 2 * st->clockCheckInterval;
+    st->clockCheckInterval = std::clamp(interval, MIN_CLOCK_CHECK_INTERVAL, MAX_CLOCK_CHECK_INTERVAL);
+    st->lastPollNodes = st->nodes;
+    st->lastPollMs = elapsed;
+    st->nextClockCheck = st->nodes + st->clockCheckInterval;
+}
+
+static inline void countNode(SearchThread* st) {
+    if (++st->nodes >= st->nextClockCheck)
+        pollSearchClock(st);
+}
+
+static bool searchStopped() {
+    return stopRequested.load(std::memory_order_relaxed) || helpersStop.load(std::memory_order_relaxed);
+}
+
+void stopSearch() {
+    stopRequested = true;
+}
+
+void clearSearchStop() {
+    stopRequested = false;
+}
 
-int quiescenceSearch(ChessBoard* board, int limit, int alpha, int beta, Color col) {
-    nodesExamined++;
+bool searchStopRequested() {
+    return stopRequested.load();
+}
+
+void SearchThread::reset() {
+    nodes = 0;
+    nextClockCheck = 0;
+    clockCheckInterval = MIN_CLOCK_CHECK_INTERVAL;
+    lastPollNodes = 0;
+    lastPollMs = 0;
+    for (auto& k : killers)
+        k.fill(NULL_MOVE);
+}
+
+int quiescenceSearch(SearchThread* st, ChessBoard* board, int limit, int alpha, int beta, Color col) {
+    countNode(st);
+    // In check there is no standing pat: every evasion is searched, and having none is
+    // mate. Out of check only tactical moves are tried, so stalemate is not detected here.
+    bool inCheck = board->isCheck(col);
+    MoveList moves;
+    if (inCheck) {
+        moves = MoveGenerator::generateMoves(board, EVASIONS);
+        if (moves.empty())
+            return -WIN_VALUE;
+    }
     int evalScore = evaluatePosition(board) * FACTOR[col];
-    if (evalScore >= beta)
-        return beta;
-    int delta = QUEEN_VALUE;
-    if (evalScore < alpha - delta)
-        return alpha;
-    if (alpha < evalScore)
-        alpha = evalScore;
+    if (!inCheck) {
+        if (evalScore >= beta)
+            return beta;
+        int delta = QUEEN_VALUE;
+        if (evalScore < alpha - delta)
+            return alpha;
+        if (alpha < evalScore)
+            alpha = evalScore;
+    }
     if (limit == 0)
         return evalScore;
-    std::vector<Move> captureMoves = MoveGenerator::generateCaptures(board);
-    for (const Move& mv : captureMoves) {
-        if (mv.moveType == CAPTURE || mv.moveType == CAPTUREANDPROMOTION || mv.moveType == ENPASSANT) {
-            board->makeMove(mv);
-            int score = -quiescenceSearch(board, limit - 1, -beta, -alpha, reverseColor(col));
-            board->undo();
-            if (score >= beta)
-                return beta;
-            if (score > alpha)
-                alpha = score;
-        }
+    if (!inCheck)
+        moves = MoveGenerator::generateTactical(board, TACTICAL_PROMOTIONS);
+    for (PackedMove mv : moves) {
+        board->makeMove(mv);
+        int score = -quiescenceSearch(st, board, limit - 1, -beta, -alpha, reverseColor(col));
+        board->undo();
+        if (score >= beta)
+            return beta;
+        if (score > alpha)
+            alpha = score;
     }
     return alpha;
 }
 
-void orderPVMoves(ChessBoard* board, std::vector<Move>& moves, const Move& pvMove, Color col, int depth, int rd) {
-    std::vector<MoveBonus> bonuses;
-    for (size_t i = 0; i < moves.size(); i++) {
-        if (moves[i] == pvMove) {
-            std::swap(moves[i], moves[0]);
-            bonuses.push_back({ moves[i], 30000 });
-        } else {
-            int bonusVal = 0;
-            if (moves[i].moveType == CAPTUREANDPROMOTION) {
-                bonusVal = MATERIAL.at(moves[i].promotionPiece) - MATERIAL.at(moves[i].capturedPiece) - MATERIAL.at(moves[i].mPiece);
-                bonusVal *= FACTOR[col];
-            } else if (moves[i].moveType == CAPTURE) {
-                bonusVal = -MATERIAL.at(moves[i].capturedPiece) - MATERIAL.at(moves[i].mPiece);
-                bonusVal *= FACTOR[col];
-            } else if (moves[i].moveType == PROMOTION) {
-                bonusVal = MATERIAL.at(moves[i].promotionPiece) - MATERIAL.at(moves[i].mPiece);
-                bonusVal *= FACTOR[col];
-            } else {
-                bonusVal = 0;
-                if (moves[i].toUCI() == killerMoves[depth][0].toUCI())
-                    bonusVal = 150;
-                else if (moves[i].toUCI() == killerMoves[depth][1].toUCI())
-                    bonusVal = 140;
-                if (depth >= rd) {
-                    switch (moves[i].mPiece) {
-                        case wN: bonusVal += knightSquareTable[moves[i].dest] - knightSquareTable[moves[i].src]; break;
-                        case bN: bonusVal += knightSquareTable[REVERSE_PSQ[moves[i].dest]] - knightSquareTable[REVERSE_PSQ[moves[i].src]]; break;
-                        case wB: bonusVal += bishopSquareTable[moves[i].dest] - bishopSquareTable[moves[i].src]; break;
-                        case bB: bonusVal += bishopSquareTable[REVERSE_PSQ[moves[i].dest]] - bishopSquareTable[REVERSE_PSQ[moves[i].src]]; break;
-                        case wR: bonusVal += rookSquareTable[moves[i].dest] - rookSquareTable[moves[i].src]; break;
-                        case bR: bonusVal += rookSquareTable[REVERSE_PSQ[moves[i].dest]] - rookSquareTable[REVERSE_PSQ[moves[i].src]]; break;
-                        case wQ: bonusVal += queenSquareTable[moves[i].dest] - queenSquareTable[moves[i].src]; break;
-                        case bQ: bonusVal += queenSquareTable[REVERSE_PSQ[moves[i].dest]] - queenSquareTable[REVERSE_PSQ[moves[i].src]]; break;
-                        case wP: bonusVal += pawnSquareTable[moves[i].dest] - pawnSquareTable[moves[i].src]; break;
-                        case bP: bonusVal += pawnSquareTable[REVERSE_PSQ[moves[i].dest]] - pawnSquareTable[REVERSE_PSQ[moves[i].src]]; break;
-                        default: break;
-                    }
-                }
-            }
-            bonuses.push_back({ moves[i], bonusVal });
-        }
-    }
-    std::sort(bonuses.begin(), bonuses.end(), [](const MoveBonus& a, const MoveBonus& b) {
-        return a.bonus > b.bonus;
-    });
-    for (size_t i = 0; i < bonuses.size(); i++) {
-        moves[i] = bonuses[i].mv;
-    }
-}
-
-std::pair<int, bool> principalVariationSearch(ChessBoard* board, int depth, int rd, int alpha, int beta, Color col, bool doNull, std::vector<Move>& pvLine, int64_t tRem, std::chrono::steady_clock::time_point startTime) {
-    nodesExamined++;
-    std::vector<Move> localPV;
+std::pair<int, bool> principalVariationSearch(SearchThread* st, ChessBoard* board, int depth, int rd, int alpha, int beta, Color col, bool doNull, std::vector<PackedMove>& pvLine) {
+    countNode(st);
+    std::vector<PackedMove> localPV;
     if (depth <= 0) {
-        return { quiescenceSearch(board, 4, alpha, beta, col), false };
-    }
-    std::vector<Move> legalMoves = board->generateLegalMoves();
-    if (legalMoves.empty()) {
-        int sc = evaluatePosition(board) * FACTOR[col];
-        return { sc, false };
+        return { quiescenceSearch(st, board, 4, alpha, beta, col), false };
     }
     if (board->isThreeFoldRep()) {
         return { 0, false };
     }
     int bestScore = 0;
     bool timeOut = false;
-    Move bestMove;
+    PackedMove bestMove = NULL_MOVE;
     int origAlpha = alpha;
-    if (probeTT(board, &bestScore, &alpha, &beta, depth, rd, &bestMove)) {
+    if (probeTransTable(board, &bestScore, &alpha, &beta, depth, rd, &bestMove).first) {
         pvLine.clear();
         pvLine.push_back(bestMove);
         pvLine.insert(pvLine.end(), localPV.begin(), localPV.end());
         return { bestScore, false };
     }
-    if (depth > 1) {
-        orderPVMoves(board, legalMoves, bestMove, col, depth, rd);
-    }
     bool inCheck = board->isCheck(col);
     if (inCheck)
         depth++;
     uint64_t nonPawn = board->colorBitboards[col] ^ board->getPiecesByColor(pawn, col);
     if (doNull && !inCheck && nonPawn != 0 && board->plyCnt > 0) {
         board->makeNullMove();
-        auto result = principalVariationSearch(board, depth - NULL_MOVE_RED - 1, rd, -beta, -beta + 1, reverseColor(col), false, localPV, tRem, std::chrono::steady_clock::now());
+        auto result = principalVariationSearch(st, board, depth - NULL_MOVE_RED - 1, rd, -beta, -beta + 1, reverseColor(col), false, localPV);
         int score = -result.first;
         board->undoNullMove();
+        if (result.second) {
+            pvLine.clear();
+            return { bestScore, true };
+        }
         if (score >= beta)
-            return { beta, result.second };
+            return { beta, false };
         if (score > alpha)
             alpha = score;
     }
-    for (size_t i = 0; i < legalMoves.size(); i++) {
-        if (timeOut)
+    MovePicker picker(board, bestMove, st->killers[depth][0], st->killers[depth][1], st->history[depth], inCheck);
+    size_t i = 0;
+    // i is only advanced by the loop increment, which a cutoff skips, so whether any
+    // move was searched at all is counted separately.
+    int movesSearched = 0;
+    // A child that was stopped returns a partial score. It is never allowed to move alpha,
+    // the PV or the best move, and timeOut keeps the node out of the TT; the move is
+    // always taken back before leaving the loop.
+    for (PackedMove mv = picker.nextMove(); !mv.isNull(); mv = picker.nextMove(), i++) {
+        if (searchStopped()) {
+            timeOut = true;
             break;
-        int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
-        if (elapsed > tRem) {
-            pvLine.clear();
-            return { bestScore, true };
         }
-        board->makeMove(legalMoves[i]);
+        board->makeMove(mv);
+        movesSearched++;
         if (i == 0) {
-            auto result = principalVariationSearch(board, depth - 1, rd, -beta, -alpha, reverseColor(col), true, localPV, tRem, std::chrono::steady_clock::now());
-            bestScore = -result.first;
-            timeOut = result.second;
+            auto result = principalVariationSearch(st, board, depth - 1, rd, -beta, -alpha, reverseColor(col), true, localPV);
             board->undo();
-            if (bestScore > alpha && !timeOut) {
-                bestMove = legalMoves[i];
+            timeOut = result.second;
+            if (timeOut)
+                break;
+            bestScore = -result.first;
+            if (bestScore > alpha) {
+                bestMove = mv;
                 pvLine.clear();
-                pvLine.push_back(legalMoves[i]);
+                pvLine.push_back(mv);
                 pvLine.insert(pvLine.end(), localPV.begin(), localPV.end());
                 if (bestScore >= beta) {
-                    if (killerMoves[depth][0].toUCI() != legalMoves[i].toUCI()) {
-                        killerMoves[depth][1] = killerMoves[depth][0];
-                        killerMoves[depth][0] = legalMoves[i];
+                    if (!mv.isCapture() && st->killers[depth][0] != mv) {
+                        st->killers[depth][1] = st->killers[depth][0];
+                        st->killers[depth][0] = mv;
                     }
-                    historyHeuristic[depth][legalMoves[i].src][legalMoves[i].dest]++;
+                    st->history[depth][mv.from()][mv.to()]++;
                     break;
                 }
                 alpha = bestScore;
@@ -170,98 +196,257 @@ std::pair<int, bool> principalVariationSearch(ChessBoard* board, int depth, int
         } else {
             int score = alpha + 1;
             bool chk = board->isCheck(board->sideToMove);
-            if (i >= 4 && depth >= 3 && legalMoves[i].moveType != CAPTURE && legalMoves[i].moveType != CAPTUREANDPROMOTION && !chk) {
-                auto result = principalVariationSearch(board, depth - 2, rd, -alpha - 1, -alpha, reverseColor(col), true, localPV, tRem, std::chrono::steady_clock::now());
+            if (i >= 4 && depth >= 3 && !mv.isCapture() && !chk) {
+                auto result = principalVariationSearch(st, board, depth - 2, rd, -alpha - 1, -alpha, reverseColor(col), true, localPV);
                 score = -result.first;
+                timeOut |= result.second;
             }
-            if (score > alpha) {
-                auto result = principalVariationSearch(board, depth - 1, rd, -alpha - 1, -alpha, reverseColor(col), true, localPV, tRem, std::chrono::steady_clock::now());
+            if (score > alpha && !timeOut) {
+                auto result = principalVariationSearch(st, board, depth - 1, rd, -alpha - 1, -alpha, reverseColor(col), true, localPV);
                 score = -result.first;
-                if (timeOut)
-                    break;
-                if (score > alpha && score < beta) {
-                    auto result2 = principalVariationSearch(board, depth - 1, rd, -beta, -alpha, reverseColor(col), true, localPV, tRem, std::chrono::steady_clock::now());
+                timeOut |= result.second;
+                if (score > alpha && score < beta && !timeOut) {
+                    auto result2 = principalVariationSearch(st, board, depth - 1, rd, -beta, -alpha, reverseColor(col), true, localPV);
                     score = -result2.first;
+                    timeOut |= result2.second;
                 }
-                if (score > alpha && !timeOut) {
-                    bestMove = legalMoves[i];
+                board->undo();
+                if (timeOut)
+                    break;
+                if (score > alpha) {
+                    bestMove = mv;
                     alpha = score;
                     pvLine.clear();
-                    pvLine.push_back(legalMoves[i]);
+                    pvLine.push_back(mv);
                     pvLine.insert(pvLine.end(), localPV.begin(), localPV.end());
                 }
-                board->undo();
-                if (score > bestScore && !timeOut) {
+                if (score > bestScore) {
                     bestScore = score;
                     if (score >= beta) {
-                        if (killerMoves[depth][0].toUCI() != legalMoves[i].toUCI()) {
-                            killerMoves[depth][1] = killerMoves[depth][0];
-                            killerMoves[depth][0] = legalMoves[i];
+                        if (!mv.isCapture() && st->killers[depth][0] != mv) {
+                            st->killers[depth][1] = st->killers[depth][0];
+                            st->killers[depth][0] = mv;
                         }
-                        historyHeuristic[depth][legalMoves[i].src][legalMoves[i].dest]++;
+                        st->history[depth][mv.from()][mv.to()]++;
                         break;
                     }
                 }
             } else {
                 board->undo();
+                if (timeOut)
+                    break;
             }
         }
     }
-    if (!timeOut) {
-        Bound flag;
-        if (bestScore <= origAlpha)
-            flag = UPPER;
-        else if (bestScore >= beta)
-            flag = LOWER;
-        else
-            flag = EXACT;
-        storeEntry(board, bestScore, flag, bestMove, depth);
+    if (timeOut) {
+        pvLine.clear();
+        return { bestScore, true };
+    }
+    if (movesSearched == 0) {
+        // No legal moves: checkmate or stalemate. The static evaluation never generates
+        // moves, so this is the only place either is recognised.
+        return { inCheck ? -WIN_VALUE : 0, false };
+    }
+    BoundType flag;
+    if (bestScore <= origAlpha)
+        flag = UPPER_BOUND;
+    else if (bestScore >= beta)
+        flag = LOWER_BOUND;
+    else
+        flag = EXACT_BOUND;
+    storeTransEntry(board, bestScore, flag, bestMove, depth);
+    return { bestScore, false };
+}
+
+void setSearchThreads(int threads) {
+    searchThreads = threads < 1 ? 1 : threads;
+}
+
+// Each thread counts into its own SearchThread; the totals are only summed once every
+// helper has finished the search, so no counter is shared while searching.
+uint64_t lastSearchNodes() {
+    uint64_t total = 0;
+    for (const auto& st : searchPool)
+        total += st->nodes;
+    return total;
+}
+
+// Lazy SMP helper: the same iterative deepening as the main thread on a private copy of
+// the board, talking to the others only through the shared transposition table. Odd
+// helpers start a ply deeper so the threads spread over neighbouring depths instead of
+// walking the same tree in lockstep. Runs until the main thread raises helpersStop.
+// helpersStop reaches PVS through searchStopped like any other stop, so an aborted
+// helper unwinds with every node flagged as timed out and writes nothing to the shared
+// table; only subtrees it finished are stored, and those are as good as the main
+// thread's. Keep it that way: the table outlives the search, so a partial score stored
+// here would be probed as a real bound on later moves.
+static void helperSearch(SearchThread* st, ChessBoard board, int threadId, int maxDepth) {
+    std::vector<PackedMove> pvLine;
+    for (int d = 1 + (threadId & 1); d <= maxDepth && !helpersStop.load(std::memory_order_relaxed); d++) {
+        auto result = principalVariationSearch(st, &board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board.sideToMove, true, pvLine);
+        if (result.second)
+            break;
+    }
+}
+
+// Helpers are persistent workers, parked between searches, rather than threads started
+// for every move: their thread_local pawn tables and TT counters then stay warm from
+// one search to the next. A search bumps helperJob to wake them and waits for
+// helpersRunning to drop to zero before returning. Guarded by helperMutex.
+static std::mutex helperMutex;
+static std::condition_variable helperCv;
+static uint64_t helperJob = 0;
+static int helpersRunning = 0;
+static bool helpersQuit = false;
+static ChessBoard helperBoard;
+static int helperMaxDepth = 0;
+
+static void helperLoop(int threadId, uint64_t seenJob) {
+    std::unique_lock<std::mutex> lock(helperMutex);
+    while (true) {
+        helperCv.wait(lock, [&] { return helperJob != seenJob || helpersQuit; });
+        if (helpersQuit)
+            return;
+        seenJob = helperJob;
+        ChessBoard board = helperBoard;
+        int maxDepth = helperMaxDepth;
+        SearchThread* st = searchPool[threadId].get();
+        lock.unlock();
+        helperSearch(st, board, threadId, maxDepth);
+        lock.lock();
+        if (--helpersRunning == 0)
+            helperCv.notify_all();
     }
-    return { bestScore, timeOut };
 }
 
-Move searchWithTime(ChessBoard* board, int64_t moveTime) {
+static void stopHelperThreads(std::vector<std::thread>& threads) {
+    {
+        std::lock_guard<std::mutex> lock(helperMutex);
+        helpersQuit = true;
+    }
+    helperCv.notify_all();
+    for (std::thread& t : threads)
+        t.join();
+    threads.clear();
+    helpersQuit = false;
+}
+
+// Joins the helpers at exit, which would otherwise terminate the process by destroying
+// joinable threads. Declared after the state above so it is destroyed first.
+struct HelperPool {
+    std::vector<std::thread> threads;
+    ~HelperPool() { stopHelperThreads(threads); }
+};
+static HelperPool helperPool;
+
+// Only called between searches. The helpers are restarted only when the thread count
+// changed, so in a game they are created once.
+static void resizeSearchPool() {
+    while (int(searchPool.size()) < searchThreads)
+        searchPool.push_back(std::make_unique<SearchThread>());
+    if (int(helperPool.threads.size()) == searchThreads - 1)
+        return;
+    stopHelperThreads(helperPool.threads);
+    searchPool.resize(searchThreads);
+    for (int t = 1; t < searchThreads; t++)
+        helperPool.threads.emplace_back(helperLoop, t, helperJob);
+}
+
+PackedMove searchWithTime(ChessBoard* board, int64_t moveTime, int maxDepth) {
+    clearSearchStop();
+    setMoveTime(moveTime);
+    return searchWithLimits(board, maxDepth);
+}
+
+// Iterative deepening against the search clock. The soft limit is rescaled after every
+// iteration from how stable the best move and score are, and re-read before the next;
+// the hard one is checked at every clock poll, so a ponderhit or stop from the UCI
+// thread takes effect without restarting the search.
+PackedMove searchWithLimits(ChessBoard* board, int maxDepth) {
+    // Helpers get the same clamped depth, so no thread indexes past the per-depth tables.
+    maxDepth = std::min(maxDepth, MAX_SEARCH_DEPTH);
     board->printFromBitboards();
-    auto startTime = std::chrono::steady_clock::now();
-    std::vector<Move> pvLine;
-    std::vector<Move> legalMoves = board->generateLegalMoves();
-    Move prevBest;
+    newSearchGeneration();
+    resizeSearchPool();
+    for (auto& st : searchPool)
+        st->reset();
+    SearchThread* main = searchPool[0].get();
+    std::vector<PackedMove> pvLine;
+    MoveList legalMoves = board->generateLegalMoves();
+    PackedMove prevBest = NULL_MOVE;
+    // Mate or stalemate on the board: there is nothing to search, and UCI expects
+    // "bestmove 0000".
+    if (legalMoves.empty())
+        return NULL_MOVE;
     if (legalMoves.size() == 1)
         return legalMoves[0];
-    for (int d = 1; d <= 100; d++) {
-        nodesExamined = 0;
-        int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
-        int64_t timeLeft = moveTime - elapsed;
-        if (moveTime > timeLeft * 2)
+    helpersStop = false;
+    if (searchThreads > 1) {
+        std::lock_guard<std::mutex> lock(helperMutex);
+        helperBoard = *board;
+        helperMaxDepth = maxDepth;
+        helpersRunning = searchThreads - 1;
+        helperJob++;
+    }
+    helperCv.notify_all();
+    double bestMoveChanges = 0;
+    int prevScore = 0;
+    int64_t lastIterationMs = 0;
+    for (int d = 1; d <= maxDepth; d++) {
+        uint64_t nodesBefore = main->nodes;
+        if (stopRequested.load())
             break;
+        if (d > 1) {
+            int64_t elapsed = searchElapsedMs();
+            if (elapsed > searchSoftLimit())
+                break;
+            // An aborted iteration is thrown away, so one that would need more time than
+            // is left before the hard limit is not worth starting.
+            if (elapsed + ITERATION_GROWTH * lastIterationMs > searchHardLimit())
+                break;
+        }
         auto searchStart = std::chrono::steady_clock::now();
-        auto result = principalVariationSearch(board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board->sideToMove, true, pvLine, timeLeft, std::chrono::steady_clock::now());
+        auto result = principalVariationSearch(main, board, d, d, -WIN_VALUE - 1, WIN_VALUE + 1, board->sideToMove, true, pvLine);
         int score = result.first;
         bool timeout = result.second;
         int64_t timeTaken = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - searchStart).count();
         if (timeout)
-            return prevBest;
+            break;
+        lastIterationMs = timeTaken;
         board->makeMove(pvLine[0]);
         if (board->isTwoFold() && score > 0) {
-            clearTTable();
+            removeTransEntry(board);
             board->undo();
-            std::cout << "Two-fold repetition encountered, removing TT entry\n";
-            clearTTable();
+            removeTransEntry(board);
+            sendLine("info string two-fold repetition, removing TT entry");
         } else {
             board->undo();
         }
         std::string pvStr;
-        for (const Move& mv : pvLine) {
+        for (PackedMove mv : pvLine) {
             pvStr += " " + mv.toUCI();
         }
         int signedScore = score * FACTOR[board->sideToMove];
-        std::cout << "info depth " << d << " nodes " << nodesExamined << " time " << timeTaken << " score cp " << signedScore << " pv" << pvStr << "\n";
-        if (score == WIN_VALUE || score == -WIN_VALUE) {
-            clearTTable();
-            return pvLine[0];
-        }
+        sendLine("info depth " + std::to_string(d) + " nodes " + std::to_string(main->nodes - nodesBefore) + " time " +
+                 std::to_string(timeTaken) + " score cp " + std::to_string(signedScore) + " pv" + pvStr);
+        bestMoveChanges /= 2;
+        if (d > 1 && pvLine[0] != prevBest)
+            bestMoveChanges += 1;
+        if (d > 1)
+            updateTimeScale(bestMoveChanges, prevScore - score);
+        prevScore = score;
         prevBest = pvLine[0];
+        if (score == WIN_VALUE || score == -WIN_VALUE)
+            break;
     }
+    helpersStop = true;
+    {
+        std::unique_lock<std::mutex> lock(helperMutex);
+        helperCv.wait(lock, [] { return helpersRunning == 0; });
+    }
+    // Stopped before the first iteration finished: any legal move beats no move.
+    if (prevBest.isNull() && !legalMoves.empty())
+        return legalMoves[0];
     return prevBest;
 }
 
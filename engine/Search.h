@@ -3,24 +3,48 @@
 
 #include "Board.h"
 #include "Move.h"
+#include "MoveList.h"
+#include <array>
 #include <vector>
 #include <utility>
-#include <chrono>
 #include <cstdint>
 
 namespace Chess {
 
-enum Bound { UPPER, LOWER, EXACT };
+const int MAX_SEARCH_DEPTH = 100;
+// Rows in the per-depth tables. The check extension lets a node see one more than the
+// iteration depth, so a search to MAX_SEARCH_DEPTH indexes up to MAX_SEARCH_DEPTH + 1.
+const int SEARCH_TABLE_ROWS = MAX_SEARCH_DEPTH + 2;
 
-int quiescenceSearch(ChessBoard* board, int depthLimit, int alpha, int beta, Color col);
-void orderPVMoves(ChessBoard* board, std::vector<Move>& moves, const Move& pvMove, Color col, int depth, int rd);
-std::pair<int, bool> principalVariationSearch(ChessBoard* board, int depth, int rd, int alpha, int beta, Color col, bool doNull, std::vector<Move>& pvLine, int64_t timeRemaining, std::chrono::steady_clock::time_point startTime);
-Move searchWithTime(ChessBoard* board, int64_t moveTime);
+// Everything a search thread writes besides the board and the shared TT. Aligned to a
+// cache line so counters of different threads never share one, with the small, hot
+// killer table ahead of the 1.6 MB history table.
+struct alignas(64) SearchThread {
+    uint64_t nodes = 0;
+    // Node count at which this thread next reads the search clock, and the bookkeeping
+    // that sizes the gap between reads from its node rate.
+    uint64_t nextClockCheck = 0;
+    uint64_t clockCheckInterval = 64;
+    uint64_t lastPollNodes = 0;
+    int64_t lastPollMs = 0;
+    std::array<std::array<PackedMove, 2>, SEARCH_TABLE_ROWS> killers{};
+    std::array<std::array<std::array<int, 64>, 64>, SEARCH_TABLE_ROWS> history{};
 
-// The following functions are assumed to exist in the transposition table module.
-bool probeTT(ChessBoard* board, int* bestScore, int* alpha, int* beta, int depth, int rd, Move* bestMove);
-void storeEntry(ChessBoard* board, int score, Bound flag, const Move& bestMove, int depth);
-void clearTTable();
+    // Only the counters and killers start over between searches; history is kept.
+    void reset();
+};
+
+int quiescenceSearch(SearchThread* st, ChessBoard* board, int depthLimit, int alpha, int beta, Color col);
+std::pair<int, bool> principalVariationSearch(SearchThread* st, ChessBoard* board, int depth, int rd, int alpha, int beta, Color col, bool doNull, std::vector<PackedMove>& pvLine);
+PackedMove searchWithTime(ChessBoard* board, int64_t moveTime, int maxDepth = MAX_SEARCH_DEPTH);
+PackedMove searchWithLimits(ChessBoard* board, int maxDepth = MAX_SEARCH_DEPTH);
+
+// Controls the UCI thread uses while a search runs on the worker thread.
+void stopSearch();
+void clearSearchStop();
+bool searchStopRequested();
+void setSearchThreads(int threads);
+uint64_t lastSearchNodes();
 
 } // namespace Chess
 
@@ -0,0 +1,83 @@
+#include "TimeManager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace Chess {
+
+// Kept back from every clock for GUI and pipe latency, so a move that uses its whole
+// maximum still arrives in time.
+static const int64_t MOVE_OVERHEAD = 50;
+// Moves assumed left in sudden death, and the cap on a long movestogo.
+static const int DEFAULT_MOVES_TO_GO = 30;
+static const int MAX_MOVES_TO_GO = 50;
+// One move may take at most this many optimums, and never more than a third of the
+// clock unless it is the last move before the time control.
+static const int64_t MAX_OPTIMUM_RATIO = 4;
+
+// Written by the UCI thread (go, ponderhit) and by the main search thread while other
+// search threads read them, so each is atomic. A reader may briefly pair a new start
+// with old limits; that only moves one poll by a millisecond or so.
+static std::atomic<int64_t> clockStartMs(0);
+static std::atomic<int64_t> optimumMs(INFINITE_TIME);
+static std::atomic<int64_t> softLimitMs(INFINITE_TIME);
+static std::atomic<int64_t> hardLimitMs(INFINITE_TIME);
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TimeBudget allocateTime(const TimeControl& tc) {
+    if (tc.moveTime > 0) {
+        int64_t moveTime = std::max<int64_t>(tc.moveTime - MOVE_OVERHEAD, 1);
+        return { moveTime, moveTime };
+    }
+    int movesToGo = tc.movesToGo > 0 ? std::min(tc.movesToGo, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+    int64_t available = std::max<int64_t>(tc.time - MOVE_OVERHEAD, 1);
+    int64_t optimum = available / movesToGo + tc.inc * 3 / 4;
+    int64_t cap = movesToGo == 1 ? available * 9 / 10 : available / 3;
+    int64_t maximum = std::max<int64_t>(std::min(optimum * MAX_OPTIMUM_RATIO, cap), 1);
+    optimum = std::clamp<int64_t>(optimum, 1, maximum);
+    return { optimum, maximum };
+}
+
+void startSearchClock(const TimeBudget& budget) {
+    optimumMs.store(budget.optimum, std::memory_order_relaxed);
+    softLimitMs.store(budget.optimum, std::memory_order_relaxed);
+    hardLimitMs.store(budget.maximum, std::memory_order_relaxed);
+    clockStartMs.store(nowMs(), std::memory_order_relaxed);
+}
+
+void setMoveTime(int64_t moveTime) {
+    startSearchClock({ moveTime, moveTime });
+}
+
+// A best move that keeps changing, or a score that just fell, means the position is not
+// understood yet and deserves more time; a best move that has held for several
+// iterations is unlikely to change with one more. The soft limit ranges from 0.75x to
+// 2.6x the optimum, and never passes the maximum.
+void updateTimeScale(double bestMoveChanges, int scoreDrop) {
+    int64_t optimum = optimumMs.load(std::memory_order_relaxed);
+    int64_t maximum = hardLimitMs.load(std::memory_order_relaxed);
+    if (optimum >= maximum)
+        return;
+    double instability = 0.75 + 0.5 * bestMoveChanges;
+    double falling = std::clamp(1.0 + scoreDrop / 200.0, 1.0, 1.5);
+    int64_t soft = int64_t(double(optimum) * instability * falling);
+    softLimitMs.store(std::min(soft, maximum), std::memory_order_relaxed);
+}
+
+int64_t searchElapsedMs() {
+    return nowMs() - clockStartMs.load(std::memory_order_relaxed);
+}
+
+int64_t searchSoftLimit() {
+    return softLimitMs.load(std::memory_order_relaxed);
+}
+
+int64_t searchHardLimit() {
+    return hardLimitMs.load(std::memory_order_relaxed);
+}
+
+} // namespace Chess
@@ -0,0 +1,48 @@
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+#include <cstdint>
+
+namespace Chess {
+
+// Limit for searches that only end on "stop"; small enough that adding it to a clock
+// reading cannot overflow.
+const int64_t INFINITE_TIME = INT64_MAX / 4;
+
+// Clock fields of a "go" command for the side to move, in milliseconds. Zero means the
+// field was not given.
+struct TimeControl {
+    int64_t time = 0;
+    int64_t inc = 0;
+    int movesToGo = 0;
+    int64_t moveTime = 0;
+};
+
+// optimum is what a move with a settled best move should take; maximum is the most any
+// move may take, and the point where the search is aborted. A fixed move time sets both
+// to the same value and is never rescaled.
+struct TimeBudget {
+    int64_t optimum;
+    int64_t maximum;
+};
+
+const TimeBudget INFINITE_BUDGET = { INFINITE_TIME, INFINITE_TIME };
+
+TimeBudget allocateTime(const TimeControl& tc);
+
+// Deadlines of the running search, in milliseconds since startSearchClock. Past the soft
+// limit no new iteration is started; at the hard limit the search is aborted. The soft
+// limit starts at the optimum and moves with updateTimeScale.
+void startSearchClock(const TimeBudget& budget);
+void setMoveTime(int64_t moveTime);
+// Called after every finished iteration. bestMoveChanges is a decaying count of how often
+// the best move changed recently; scoreDrop is how far the score fell since the previous
+// iteration, in centipawns.
+void updateTimeScale(double bestMoveChanges, int scoreDrop);
+int64_t searchElapsedMs();
+int64_t searchSoftLimit();
+int64_t searchHardLimit();
+
+} // namespace Chess
+
+#endif // TIMEMANAGER_H
@@ -1,32 +1,151 @@
 #include "TTable.h"
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 namespace Chess {
 
 TransTable transTable;
 
+// Probe statistics are kept per thread so helper threads never share a counter.
+static thread_local uint64_t transProbes = 0;
+static thread_local uint64_t transHits = 0;
+
+// Generations live in the top six bits of genBound.
+static const int GENERATION_CYCLE = 64;
+
+// Tables are aligned to and sized in whole 2 MB pages so the kernel can back them with
+// transparent huge pages, which cuts TLB misses on random probes into a large table.
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Reallocates only when the size changes, so the "isready" that follows every position
+// setup does not throw the table away.
 void initTransTable(int mb) {
-    transTable.tableSize = static_cast<uint64_t>(mb) * 1024 * 1024 / sizeof(TransEntry);
-    transTable.entries.resize(transTable.tableSize);
+    size_t bytes = static_cast<size_t>(mb) * 1024 * 1024;
+    size_t alignment = bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(TransCluster);
+    bytes = std::max((bytes + alignment - 1) / alignment * alignment, sizeof(TransCluster));
+    if (transTable.clusters != nullptr && transTable.allocatedBytes == bytes)
+        return;
+    std::free(transTable.clusters);
+    transTable.clusters = static_cast<TransCluster*>(std::aligned_alloc(alignment, bytes));
+    if (transTable.clusters == nullptr) {
+        std::cerr << "Failed to allocate a " << mb << " MB transposition table" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+#ifdef __linux__
+    if (alignment == HUGE_PAGE_SIZE)
+        madvise(transTable.clusters, bytes, MADV_HUGEPAGE);
+#endif
+    transTable.allocatedBytes = bytes;
+    transTable.clusterCount = bytes / sizeof(TransCluster);
+    clearTransTable();
 }
 
+// Zero-fills the table in one slice per hardware thread. Writing the pages from several
+// threads also spreads first-touch page faults over the cores.
 void clearTransTable() {
-    transTable.entries.assign(transTable.tableSize, TransEntry());
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t slice = (transTable.clusterCount + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threadCount; t++) {
+        size_t begin = t * slice;
+        size_t end = std::min<size_t>(begin + slice, transTable.clusterCount);
+        if (begin >= end)
+            break;
+        workers.emplace_back([begin, end]() {
+            std::memset(static_cast<void*>(transTable.clusters + begin), 0, (end - begin) * sizeof(TransCluster));
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    transTable.generation = 0;
+    transProbes = 0;
+    transHits = 0;
+}
+
+// Called once per search. Entries written by earlier searches stay probeable but age,
+// and the replacement policy prefers to overwrite them, so the table never needs a
+// full clear between moves.
+void newSearchGeneration() {
+    transTable.generation = (transTable.generation + 1) % GENERATION_CYCLE;
+}
+
+// Maps the key onto [0, clusterCount) with a multiply-high instead of a 64-bit modulo;
+// any table size works and the index is taken from the high bits of the key.
+static TransCluster& clusterFor(uint64_t hash) {
+    uint64_t index = static_cast<uint64_t>((static_cast<unsigned __int128>(hash) * transTable.clusterCount) >> 64);
+    return transTable.clusters[index];
+}
+
+static TransData loadEntry(const TransEntry& entry) {
+    uint32_t scoreWord = entry.scoreWord.load(std::memory_order_relaxed);
+    uint32_t infoWord = entry.infoWord.load(std::memory_order_relaxed);
+    uint32_t key32 = entry.check.load(std::memory_order_relaxed) ^ scoreWord ^ infoWord;
+    return { key32, static_cast<int32_t>(scoreWord), PackedMove(static_cast<uint16_t>(infoWord)),
+             static_cast<int8_t>(infoWord >> 16), static_cast<uint8_t>(infoWord >> 24) };
+}
+
+static void writeEntry(TransEntry& entry, const TransData& data) {
+    uint32_t scoreWord = static_cast<uint32_t>(data.score);
+    uint32_t infoWord = uint32_t(data.bestMove.data) | uint32_t(uint8_t(data.depth)) << 16 | uint32_t(data.genBound) << 24;
+    entry.check.store(data.key32 ^ scoreWord ^ infoWord, std::memory_order_relaxed);
+    entry.scoreWord.store(scoreWord, std::memory_order_relaxed);
+    entry.infoWord.store(infoWord, std::memory_order_relaxed);
+}
+
+static int entryAge(const TransData& data) {
+    return (transTable.generation - data.generation() + GENERATION_CYCLE) % GENERATION_CYCLE;
 }
 
-void storeTransEntry(ChessBoard* board, int scr, BoundType bType, const Move& mv, int depth) {
-    uint64_t index = board->zobristHash % transTable.tableSize;
-    if (!(mv.src == a1 && mv.dest == a1))
-        transTable.entries[index] = { board->zobristHash, mv, scr, depth, bType };
+void storeTransEntry(ChessBoard* board, int scr, BoundType bType, PackedMove mv, int depth) {
+    TransCluster& cluster = clusterFor(board->zobristHash);
+    uint32_t key32 = static_cast<uint32_t>(board->zobristHash);
+    // Reuse the slot already holding this position, else an empty one, else the entry
+    // worth least: shallow and left over from older searches.
+    TransEntry* replace = &cluster.entries[0];
+    TransData old = loadEntry(*replace);
+    for (TransEntry& entry : cluster.entries) {
+        TransData data = loadEntry(entry);
+        if (data.key32 == key32 || data.depth == 0) {
+            replace = &entry;
+            old = data;
+            break;
+        }
+        if (data.depth - 8 * entryAge(data) < old.depth - 8 * entryAge(old)) {
+            replace = &entry;
+            old = data;
+        }
+    }
+    if (old.key32 == key32 && old.depth != 0) {
+        // Keep a deeper result for the same position unless the new one is exact.
+        if (bType != EXACT_BOUND && depth + 2 < old.depth)
+            return;
+        if (mv.isNull())
+            mv = old.bestMove;
+    }
+    writeEntry(*replace, { key32, scr, mv, static_cast<int8_t>(depth > 127 ? 127 : depth),
+                           static_cast<uint8_t>(transTable.generation << 2 | bType) });
 }
 
-std::pair<bool, int> probeTransTable(ChessBoard* board, int* scr, int* alpha, int* beta, int depth, int rd, Move* mv) {
-    uint64_t index = board->zobristHash % transTable.tableSize;
-    const TransEntry& entry = transTable.entries[index];
-    if (entry.hashValue == board->zobristHash) {
+std::pair<bool, int> probeTransTable(ChessBoard* board, int* scr, int* alpha, int* beta, int depth, int rd, PackedMove* mv) {
+    TransCluster& cluster = clusterFor(board->zobristHash);
+    uint32_t key32 = static_cast<uint32_t>(board->zobristHash);
+    transProbes++;
+    for (const TransEntry& slot : cluster.entries) {
+        TransData entry = loadEntry(slot);
+        if (entry.key32 != key32 || entry.depth == 0)
+            continue;
+        transHits++;
         *mv = entry.bestMove;
         if (entry.depth > depth) {
             *scr = entry.score;
-            switch (entry.boundType) {
+            switch (entry.bound()) {
                 case UPPER_BOUND:
                     if (*scr < *beta && depth != rd) *beta = *scr;
                     break;
@@ -39,8 +158,37 @@ std::pair<bool, int> probeTransTable(ChessBoard* board, int* scr, int* alpha, in
             if (*alpha >= *beta)
                 return { true, *scr };
         }
+        break;
     }
     return { false, 0 };
 }
 
+void removeTransEntry(ChessBoard* board) {
+    TransCluster& cluster = clusterFor(board->zobristHash);
+    uint32_t key32 = static_cast<uint32_t>(board->zobristHash);
+    for (TransEntry& entry : cluster.entries) {
+        if (loadEntry(entry).key32 == key32)
+            writeEntry(entry, TransData());
+    }
+}
+
+// Permille of sampled slots written by the current search, as reported by UCI hashfull.
+int transTableHashfull() {
+    uint64_t sample = transTable.clusterCount < 1000 ? transTable.clusterCount : 1000;
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < sample; i++) {
+        for (const TransEntry& slot : transTable.clusters[i].entries) {
+            TransData entry = loadEntry(slot);
+            if (entry.depth != 0 && entry.generation() == transTable.generation)
+                used++;
+        }
+    }
+    return sample > 0 ? static_cast<int>(used * 1000 / (sample * CLUSTER_SIZE)) : 0;
+}
+
+// Probes and hits seen by the calling thread since the last clear.
+std::pair<uint64_t, uint64_t> transTableStats() {
+    return { transProbes, transHits };
+}
+
 } // namespace Chess
@@ -1,8 +1,10 @@
 #ifndef TTABLE_H
 #define TTABLE_H
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <atomic>
+#include <utility>
 #include "Move.h"
 #include "Board.h"
 
@@ -14,25 +16,56 @@ enum BoundType {
     EXACT_BOUND
 };
 
+// Decoded contents of a slot: the low 32 bits of the Zobrist key (the index comes from
+// the high bits), the score, the best move, the depth, and the generation and bound
+// packed into one byte. depth == 0 marks an empty slot, since leaves are never stored.
+struct TransData {
+    uint32_t key32;
+    int32_t score;
+    PackedMove bestMove;
+    int8_t depth;
+    uint8_t genBound;
+
+    BoundType bound() const { return BoundType(genBound & 3); }
+    uint8_t generation() const { return genBound >> 2; }
+};
+
+// 12-byte slot shared by all search threads without locks. The key is stored XORed with
+// both data words, so a slot torn by two threads writing at once fails the key check on
+// the next probe instead of handing back a mix of two entries.
 struct TransEntry {
-    uint64_t hashValue;
-    Move bestMove;
-    int score;
-    int depth;
-    BoundType boundType;
+    std::atomic<uint32_t> check;
+    std::atomic<uint32_t> scoreWord;
+    std::atomic<uint32_t> infoWord;
 };
 
+const int CLUSTER_SIZE = 5;
+
+// One cache line per probe: the entries of a cluster share a single 64-byte line.
+struct alignas(64) TransCluster {
+    TransEntry entries[CLUSTER_SIZE];
+    char padding[64 - CLUSTER_SIZE * sizeof(TransEntry)];
+};
+
+static_assert(sizeof(TransCluster) == 64, "TransCluster must fill exactly one cache line");
+
 struct TransTable {
-    std::vector<TransEntry> entries;
-    uint64_t tableSize;
+    TransCluster* clusters = nullptr;
+    size_t allocatedBytes = 0;
+    uint64_t clusterCount = 0;
+    uint8_t generation = 0;
 };
 
 extern TransTable transTable;
 
 void initTransTable(int megabytes);
 void clearTransTable();
-void storeTransEntry(ChessBoard* board, int score, BoundType bType, const Move& mv, int depth);
-std::pair<bool, int> probeTransTable(ChessBoard* board, int* score, int* alpha, int* beta, int depth, int rd, Move* mv);
+void newSearchGeneration();
+void removeTransEntry(ChessBoard* board);
+void storeTransEntry(ChessBoard* board, int score, BoundType bType, PackedMove mv, int depth);
+std::pair<bool, int> probeTransTable(ChessBoard* board, int* score, int* alpha, int* beta, int depth, int rd, PackedMove* mv);
+int transTableHashfull();
+std::pair<uint64_t, uint64_t> transTableStats();
 
 } // namespace Chess
 
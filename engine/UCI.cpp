@@ -2,13 +2,31 @@
 #include "Constants.h"
 #include "TTable.h"
 #include "Search.h"
+#include "TimeManager.h"
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace Chess {
 
+// Captured during static initialization, which is as close to process launch as portable
+// code gets; startup cost is measured from here.
+static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+static const int64_t DEFAULT_MOVE_TIME = 30000;
+
+static std::mutex outputMutex;
+
+void sendLine(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
 ChessBoard processPositionCmd(const std::string& cmd) {
     ChessBoard board;
     std::istringstream iss(cmd);
@@ -37,20 +55,19 @@ ChessBoard processPositionCmd(const std::string& cmd) {
     return board;
 }
 
-void processGoCmd(const std::string& cmd, ChessBoard* board) {
+GoCommand processGoCmd(const std::string& cmd, const ChessBoard* board) {
     std::istringstream iss(cmd);
     std::vector<std::string> words;
     std::string word;
     while (iss >> word) {
         words.push_back(word);
     }
+    GoCommand go { INFINITE_BUDGET, false, false };
+    TimeControl tc;
     int64_t whiteTime = 0, blackTime = 0, whiteInc = 0, blackInc = 0;
-    int64_t moveTime = 30000;
-    bool moveTimeSet = false;
     for (size_t i = 0; i < words.size(); i++) {
         if (words[i] == "movetime") {
-            moveTimeSet = true;
-            moveTime = std::stoll(words[i + 1]);
+            tc.moveTime = std::stoll(words[i + 1]);
         } else if (words[i] == "wtime") {
             whiteTime = std::stoll(words[i + 1]);
         } else if (words[i] == "winc") {
@@ -59,70 +76,192 @@ void processGoCmd(const std::string& cmd, ChessBoard* board) {
             blackTime = std::stoll(words[i + 1]);
         } else if (words[i] == "binc") {
             blackInc = std::stoll(words[i + 1]);
+        } else if (words[i] == "movestogo") {
+            tc.movesToGo = std::stoi(words[i + 1]);
+        } else if (words[i] == "infinite") {
+            go.infinite = true;
+        } else if (words[i] == "ponder") {
+            go.ponder = true;
         }
     }
-    Move bestMove;
-    if (moveTimeSet) {
-        bestMove = searchWithTime(board, moveTime);
-    } else {
-        if (board->sideToMove == WHITE) {
-            if (whiteInc >= 0)
-                moveTime = whiteTime / 25 + whiteInc - 200;
-            else
-                moveTime = whiteTime / 30;
-            bestMove = searchWithTime(board, moveTime);
-        } else {
-            if (blackInc >= 0)
-                moveTime = blackTime / 25 + blackInc - 200;
-            else
-                moveTime = blackTime / 30;
-            bestMove = searchWithTime(board, moveTime);
+    if (go.infinite)
+        return go;
+    tc.time = board->sideToMove == WHITE ? whiteTime : blackTime;
+    tc.inc = board->sideToMove == WHITE ? whiteInc : blackInc;
+    // A bare "go" with no clock at all keeps the old fixed 30 s per move.
+    if (tc.moveTime == 0 && tc.time == 0)
+        tc.moveTime = DEFAULT_MOVE_TIME;
+    go.budget = allocateTime(tc);
+    return go;
+}
+
+// The search runs on one persistent worker thread so the loop below keeps reading
+// commands while it thinks. Everything here is guarded by workerMutex.
+static std::mutex workerMutex;
+static std::condition_variable workerCv;
+static bool searchPending = false;
+static bool searching = false;
+static bool workerQuit = false;
+// Set for go infinite and go ponder: UCI forbids sending bestmove before stop or ponderhit.
+static bool holdBestMove = false;
+static TimeBudget ponderBudget = INFINITE_BUDGET;
+static ChessBoard searchBoard;
+static bool stopTimed = false;
+static std::chrono::steady_clock::time_point stopReceived;
+
+static void searchWorker() {
+    std::unique_lock<std::mutex> lock(workerMutex);
+    while (true) {
+        workerCv.wait(lock, [] { return searchPending || workerQuit; });
+        if (workerQuit)
+            return;
+        searchPending = false;
+        ChessBoard board = searchBoard;
+        lock.unlock();
+        PackedMove bestMove = searchWithLimits(&board);
+        lock.lock();
+        workerCv.wait(lock, [] { return !holdBestMove || searchStopRequested(); });
+        if (stopTimed) {
+            int64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stopReceived).count();
+            sendLine("info string stop latency " + std::to_string(latencyUs) + " us");
         }
+        sendLine("bestmove " + bestMove.toUCI());
+        searching = false;
+        workerCv.notify_all();
     }
-    std::cout << "bestmove " << bestMove.toUCI() << std::endl;
-    if (board->plyCnt % 10 == 0)
-        clearTransTable();
+}
+
+static void waitUntilIdle(std::unique_lock<std::mutex>& lock) {
+    workerCv.wait(lock, [] { return !searching; });
+}
+
+static void startSearch(const ChessBoard& board, const GoCommand& go) {
+    std::unique_lock<std::mutex> lock(workerMutex);
+    waitUntilIdle(lock);
+    searchBoard = board;
+    holdBestMove = go.infinite || go.ponder;
+    ponderBudget = go.budget;
+    stopTimed = false;
+    clearSearchStop();
+    startSearchClock(holdBestMove ? INFINITE_BUDGET : go.budget);
+    searching = true;
+    searchPending = true;
+    workerCv.notify_all();
+}
+
+static void stopWorkerSearch() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (searching) {
+        stopReceived = std::chrono::steady_clock::now();
+        stopTimed = true;
+    }
+    stopSearch();
+    workerCv.notify_all();
+}
+
+// The opponent played the expected move: the ponder search carries on as a normal timed
+// search, with the budget counted from now.
+static void ponderHit() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (!searching || !holdBestMove)
+        return;
+    startSearchClock(ponderBudget);
+    holdBestMove = false;
+    workerCv.notify_all();
+}
+
+static void shutDownWorker(std::thread& worker) {
+    stopWorkerSearch();
+    {
+        std::unique_lock<std::mutex> lock(workerMutex);
+        waitUntilIdle(lock);
+        workerQuit = true;
+        workerCv.notify_all();
+    }
+    worker.join();
+}
+
+static bool isIdle() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    return !searching;
 }
 
 void uciLoop() {
     int64_t ttSize = 256;
+    // All startup work happens before the first command is read, and the figure reported
+    // on "uci" is taken here: launch to ready, with none of the time the GUI waits before
+    // sending "uci". Generating the start position's moves touches the attack tables.
+    initSliderBackend();
     ChessBoard board;
+    board.initializeStartingPosition();
+    board.generateLegalMoves();
+    int64_t startupUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - processStart).count();
+    std::thread worker(searchWorker);
     std::string line;
     while (std::getline(std::cin, line)) {
-        if (line == "uci") {
-            initializeEverythingExceptTTable();
-            std::cout << "id name Maelstrom" << std::endl;
-            std::cout << "id author saisree27" << std::endl;
-            std::cout << "option name Hash type spin default 256 min 1 max 1024" << std::endl;
-            std::cout << "uciok" << std::endl;
+        std::istringstream lineStream(line);
+        std::string command;
+        lineStream >> command;
+        if (command == "uci") {
+            sendLine("id name Maelstrom");
+            sendLine("id author saisree27");
+            sendLine("option name Hash type spin default 256 min 1 max 16384");
+            sendLine("option name Threads type spin default 1 min 1 max 256");
+            sendLine("option name Ponder type check default false");
+            sendLine("info string startup " + std::to_string(startupUs) + " us");
+            sendLine("uciok");
         }
-        if (line == "isready") {
-            initTransTable(static_cast<int>(ttSize));
-            std::cout << "readyok" << std::endl;
+        if (command == "isready") {
+            // Answered straight away even mid-search; a new Hash size waits for the next
+            // idle isready since the table cannot be reallocated under a running search.
+            if (isIdle())
+                initTransTable(static_cast<int>(ttSize));
+            sendLine("readyok");
         }
-        if (line == "ucinewgame") {
+        if (command == "ucinewgame") {
+            {
+                std::unique_lock<std::mutex> lock(workerMutex);
+                waitUntilIdle(lock);
+            }
             board = ChessBoard();
             board.initializeStartingPosition();
+            clearTransTable();
         }
-        if (line == "quit") {
+        if (command == "quit") {
+            shutDownWorker(worker);
             std::exit(0);
         }
-        if (line.find("position") != std::string::npos) {
+        if (command == "position") {
             board = processPositionCmd(line);
         }
-        if (line.find("go") != std::string::npos) {
-            processGoCmd(line, &board);
+        if (command == "go") {
+            startSearch(board, processGoCmd(line, &board));
         }
-        if (line.find("setoption") != std::string::npos) {
+        if (command == "stop") {
+            stopWorkerSearch();
+        }
+        if (command == "ponderhit") {
+            ponderHit();
+        }
+        if (command == "setoption") {
             std::istringstream iss(line);
             std::vector<std::string> parts;
             std::string part;
             while (iss >> part) {
                 parts.push_back(part);
             }
-            ttSize = std::stoll(parts.back());
+            {
+                std::unique_lock<std::mutex> lock(workerMutex);
+                waitUntilIdle(lock);
+            }
+            // setoption name <id> value <x>
+            if (parts.size() >= 5 && parts[2] == "Threads")
+                setSearchThreads(std::stoi(parts.back()));
+            else if (parts.size() >= 5 && parts[2] == "Hash")
+                ttSize = std::stoll(parts.back());
         }
     }
+    shutDownWorker(worker);
 }
 
 } // namespace Chess
@@ -1,13 +1,26 @@
 #ifndef UCI_H
 #define UCI_H
 
+#include <cstdint>
 #include <string>
 #include "Board.h"
+#include "TimeManager.h"
 
 namespace Chess {
 
 ChessBoard processPositionCmd(const std::string& cmd);
-void processGoCmd(const std::string& cmd, ChessBoard* board);
+// Parsed "go": the time budget worked out from the clock fields, or infinite/ponder
+// searches that only end on "stop" or "ponderhit".
+struct GoCommand {
+    TimeBudget budget;
+    bool infinite;
+    bool ponder;
+};
+
+GoCommand processGoCmd(const std::string& cmd, const ChessBoard* board);
+// Writes one protocol line and flushes it. The search worker and the command loop both
+// print, so every line to the GUI goes through here to keep lines whole.
+void sendLine(const std::string& line);
 void uciLoop();
 
 } // namespace Chess
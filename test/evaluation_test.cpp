@@ -1,19 +1,33 @@
 #include <iostream>
 #include <cassert>
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
 #include "Board.h"
 #include "Evaluation.h"
 #include "Constants.h"
+#include "Search.h"
+#include "TTable.h"
 
 using namespace Chess;
 
+// Mate and stalemate are scored by the search, not the static evaluation, so these run a
+// shallow search and expect a score relative to the side to move.
+static int searchScore(ChessBoard* board, int depth = 1) {
+    std::vector<PackedMove> pvLine;
+    auto st = std::make_unique<SearchThread>();
+    return principalVariationSearch(st.get(), board, depth, depth, -WIN_VALUE - 1, WIN_VALUE + 1, board->sideToMove, false, pvLine).first;
+}
+
 void testCheckmate() {
     {
         std::string fen = "r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4";
         ChessBoard board;
         board.initializeFEN(fen);
-        int res = evaluatePosition(&board);
-        if (res != WIN_VALUE) {
-            std::cerr << "TestCheckmate (white): got " << res << ", wanted " << WIN_VALUE << std::endl;
+        int res = searchScore(&board);
+        if (res != -WIN_VALUE) {
+            std::cerr << "TestCheckmate (white): got " << res << ", wanted " << -WIN_VALUE << std::endl;
             assert(false);
         }
     }
@@ -21,7 +35,7 @@ void testCheckmate() {
         std::string fen = "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3";
         ChessBoard board;
         board.initializeFEN(fen);
-        int res = evaluatePosition(&board);
+        int res = searchScore(&board);
         if (res != -WIN_VALUE) {
             std::cerr << "TestCheckmate (black): got " << res << ", wanted " << -WIN_VALUE << std::endl;
             assert(false);
@@ -34,7 +48,7 @@ void testStalemate() {
         std::string fen = "7K/5k1P/8/8/8/8/8/8 w - - 0 1";
         ChessBoard board;
         board.initializeFEN(fen);
-        int res = evaluatePosition(&board);
+        int res = searchScore(&board);
         if (res != 0) {
             std::cerr << "TestStalemate (white): got " << res << ", wanted " << 0 << std::endl;
             assert(false);
@@ -44,7 +58,7 @@ void testStalemate() {
         std::string fen = "8/8/8/8/8/8/p1K5/k7 b - - 0 1";
         ChessBoard board;
         board.initializeFEN(fen);
-        int res = evaluatePosition(&board);
+        int res = searchScore(&board);
         if (res != 0) {
             std::cerr << "TestStalemate (black): got " << res << ", wanted " << 0 << std::endl;
             assert(false);
@@ -52,6 +66,22 @@ void testStalemate() {
     }
 }
 
+// A node with legal moves that cuts off on its first move must keep the cutoff score,
+// not be mistaken for mate or stalemate. At depth 2 most replies to white's first moves
+// are refuted by their first move, and white is a queen up, so neither 0 nor a mate
+// score can come back.
+void testCutoffIsNotTerminal() {
+    std::string fen = "rnb1kbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    clearTransTable();
+    int res = searchScore(&board, 2);
+    if (res <= 0 || res == WIN_VALUE) {
+        std::cerr << "TestCutoffIsNotTerminal: got " << res << ", wanted a positive non-mate score" << std::endl;
+        assert(false);
+    }
+}
+
 void testMaterial() {
     {
         std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
@@ -153,11 +183,74 @@ void testInsufficientMaterial() {
     }
 }
 
+void testPawnHash() {
+    std::string fen = "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    uint64_t orig = board.pawnHash;
+    board.makeMoveFromUCI("g1f3");
+    if (board.pawnHash != orig) {
+        std::cerr << "TestPawnHash (knight move): pawn key changed" << std::endl;
+        assert(false);
+    }
+    board.makeMoveFromUCI("d5e4");
+    if (board.pawnHash != board.computePawnHash()) {
+        std::cerr << "TestPawnHash (pawn capture): incremental key differs from recomputed" << std::endl;
+        assert(false);
+    }
+    int cached = 0;
+    evaluatePawns(&board, &cached);
+    evaluatePawns(&board, &cached);
+    int fresh = computePawnEntry(&board).score;
+    if (cached != 2 * fresh) {
+        std::cerr << "TestPawnHash (cache): got " << cached / 2 << ", wanted " << fresh << std::endl;
+        assert(false);
+    }
+    board.undo();
+    board.undo();
+    if (board.pawnHash != orig) {
+        std::cerr << "TestPawnHash (undo): got " << board.pawnHash << ", wanted " << orig << std::endl;
+        assert(false);
+    }
+}
+
+void testIncrementalMaterial() {
+    std::string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    int material = board.material;
+    std::array<int, 2> psq = board.psqScore;
+    std::vector<std::string> line = { "e5f7", "e7f7", "a2a4", "b4a3", "e1c1" };
+    for (const auto& uci : line)
+        board.makeMoveFromUCI(uci);
+    int scanMaterial = 0;
+    std::array<int, 2> scanPsq = { 0, 0 };
+    for (int sq = 0; sq < 64; sq++) {
+        scanMaterial += pieceMaterial[board.squareArray[sq]];
+        scanPsq[MIDDLEGAME] += pieceSquareValues[MIDDLEGAME][board.squareArray[sq]][sq];
+        scanPsq[ENDGAME] += pieceSquareValues[ENDGAME][board.squareArray[sq]][sq];
+    }
+    if (board.material != scanMaterial || board.psqScore != scanPsq) {
+        std::cerr << "TestIncrementalMaterial (make): got " << board.material << ", wanted " << scanMaterial << std::endl;
+        assert(false);
+    }
+    for (size_t i = 0; i < line.size(); i++)
+        board.undo();
+    if (board.material != material || board.psqScore != psq) {
+        std::cerr << "TestIncrementalMaterial (undo): got " << board.material << ", wanted " << material << std::endl;
+        assert(false);
+    }
+}
+
 int main() {
+    initTransTable(16);
     testCheckmate();
     testStalemate();
+    testCutoffIsNotTerminal();
     testMaterial();
     testInsufficientMaterial();
+    testPawnHash();
+    testIncrementalMaterial();
     std::cout << "All tests passed successfully." << std::endl;
     return 0;
 }
\ No newline at end of file
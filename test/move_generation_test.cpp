@@ -8,6 +8,8 @@
 #include "Evaluation.h"
 #include "Constants.h"
 #include "Move.h"
+#include "Perft.h"
+#include "MoveGen.h"
 
 // Helper function to compare two vectors of strings (ignoring order)
 bool checkSameElements(const std::vector<std::string>& a, const std::vector<std::string>& b) {
@@ -58,6 +60,24 @@ void testEnPassantPseudoPin() {
     }
 }
 
+void testEnPassantGenerationIsReadOnly() {
+    ChessBoard board;
+    board.initializeFEN("8/8/8/KPp4r/8/8/8/4k3 w - c6 0 1");
+    uint64_t hashBefore = board.zobristHash;
+    size_t historyBefore = board.moveHistory.size();
+    auto moves = board.generateLegalMoves();
+    for (const auto& move : moves) {
+        if (move.toUCI() == "b5c6") {
+            std::cerr << "TestEnPassantGenerationIsReadOnly (horizontal pin): got b5c6, wanted no en passant" << std::endl;
+            assert(false);
+        }
+    }
+    if (board.zobristHash != hashBefore || board.moveHistory.size() != historyBefore) {
+        std::cerr << "TestEnPassantGenerationIsReadOnly: board changed during move generation" << std::endl;
+        assert(false);
+    }
+}
+
 void testTwoEnPassant() {
     std::string fen = "7k/8/8/8/pPp5/8/8/7K b - b3 0 1";
     ChessBoard board;
@@ -374,6 +394,41 @@ void testThreeFoldRep() {
     }
 }
 
+void testIncrementalHash() {
+    std::string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    uint64_t orig = board.zobristHash;
+    std::vector<std::string> line = { "a2a4", "b4a3", "e1g1", "e8c8", "g1h1" };
+    for (const auto& uci : line) {
+        board.makeMoveFromUCI(uci);
+        if (board.zobristHash != board.computeHash()) {
+            std::cerr << "TestIncrementalHash (" << uci << "): incremental hash differs from recomputed" << std::endl;
+            assert(false);
+        }
+    }
+    for (size_t i = 0; i < line.size(); i++)
+        board.undo();
+    if (board.zobristHash != orig) {
+        std::cerr << "TestIncrementalHash (undo): got " << board.zobristHash << ", wanted " << orig << std::endl;
+        assert(false);
+    }
+    ChessBoard noRights;
+    noRights.initializeFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w - - 0 1");
+    if (noRights.zobristHash == orig) {
+        std::cerr << "TestIncrementalHash (castling): positions differing in rights share a hash" << std::endl;
+        assert(false);
+    }
+    ChessBoard withEp;
+    withEp.initializeFEN("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3");
+    ChessBoard withoutEp;
+    withoutEp.initializeFEN("rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3");
+    if (withEp.zobristHash == withoutEp.zobristHash) {
+        std::cerr << "TestIncrementalHash (en passant): positions differing in en passant share a hash" << std::endl;
+        assert(false);
+    }
+}
+
 void testGenerateCaptures() {
     std::string fen = "r3r1k1/pp3pbp/1qp1b1p1/2B5/2BP4/Q1n2N2/P4PPP/3R1K1R w - - 4 18";
     ChessBoard board;
@@ -406,9 +461,90 @@ void testGenerateCaptures() {
     }
 }
 
+void testGenerateTactical() {
+    ChessBoard board;
+    board.initializeFEN("1n5k/P7/8/8/8/8/8/K7 w - - 0 1");
+    std::vector<std::string> uciMoves;
+    for (const auto& m : MoveGenerator::generateTactical(&board, TACTICAL_PROMOTIONS))
+        uciMoves.push_back(m.toUCI());
+    std::vector<std::string> expected = {"a7b8n", "a7b8b", "a7b8r", "a7b8q", "a7a8q"};
+    if (!checkSameElements(expected, uciMoves)) {
+        std::cerr << "TestGenerateTactical (promotions): got ";
+        for (const auto& s : uciMoves) std::cerr << s << " ";
+        std::cerr << ", wanted ";
+        for (const auto& s : expected) std::cerr << s << " ";
+        std::cerr << std::endl;
+        assert(false);
+    }
+    uciMoves.clear();
+    for (const auto& m : MoveGenerator::generateTactical(&board, TACTICAL_CAPTURES))
+        uciMoves.push_back(m.toUCI());
+    if (uciMoves.size() != 4) {
+        std::cerr << "TestGenerateTactical (captures): got " << uciMoves.size() << " moves, wanted 4" << std::endl;
+        assert(false);
+    }
+}
+
+void testPerft() {
+    struct PerftCase {
+        std::string fen;
+        std::vector<uint64_t> counts;
+    };
+    std::vector<PerftCase> cases = {
+        { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", { 20, 400, 8902, 197281 } },
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862 } },
+        { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238 } },
+    };
+    for (const auto& pc : cases) {
+        ChessBoard board;
+        board.initializeFEN(pc.fen);
+        for (size_t d = 0; d < pc.counts.size(); d++) {
+            uint64_t nodes = perft(&board, d + 1);
+            if (nodes != pc.counts[d]) {
+                std::cerr << "TestPerft (" << pc.fen << ", depth " << d + 1 << "): got " << nodes
+                          << ", wanted " << pc.counts[d] << std::endl;
+                assert(false);
+            }
+        }
+    }
+}
+
+void testPerftHashed() {
+    std::string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    PerftTable table;
+    initPerftTable(&table, 1);
+    uint64_t nodes = perftHashed(&board, 3, &table);
+    if (nodes != 97862) {
+        std::cerr << "TestPerftHashed: got " << nodes << ", wanted " << 97862 << std::endl;
+        assert(false);
+    }
+}
+
+void testPackedMove() {
+    std::string fen = "r3k2r/1P6/8/8/8/8/8/R3K2R w KQkq - 0 1";
+    ChessBoard board;
+    board.initializeFEN(fen);
+    auto moves = board.generateLegalMoves();
+    for (const auto& m : moves) {
+        Move full = unpackMove(m, &board);
+        if (packMove(full) != m) {
+            std::cerr << "TestPackedMove (" << m.toUCI() << "): round trip changed the move" << std::endl;
+            assert(false);
+        }
+    }
+    PackedMove promo(b7, a8, FLAG_CAPTURE_PROMOTION | 3);
+    if (promo.toUCI() != "b7a8q" || !promo.isCapture() || !promo.isPromotion()) {
+        std::cerr << "TestPackedMove (capture promotion): got " << promo.toUCI() << ", wanted b7a8q" << std::endl;
+        assert(false);
+    }
+}
+
 int main() {
     testStartPos();
     testEnPassantPseudoPin();
+    testEnPassantGenerationIsReadOnly();
     testTwoEnPassant();
     testTwoEnpassantOneLegal();
     testNoPawnMoves();
@@ -421,7 +557,12 @@ int main() {
     testUndoMoveCapture();
     testAllMovesMakeUnmake();
     testThreeFoldRep();
+    testIncrementalHash();
     testGenerateCaptures();
+    testGenerateTactical();
+    testPerft();
+    testPerftHashed();
+    testPackedMove();
 
     std::cout << "All tests passed successfully." << std::endl;
     return 0;
@@ -0,0 +1,86 @@
+// Searches for magic multipliers for the offset-based ("fancy") slider tables, where each
+// square uses exactly 2^popcount(mask) slots, and prints them as the rookMagics and
+// bishopMagics initializers for engine/Constants.cpp along with the resulting table size.
+//
+// Usage: magic_search [seed]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <string>
+#include "Constants.h"
+#include "Bitboard.h"
+
+using namespace Chess;
+
+static u64 findMagic(Square s, u64 mask, bool isBishop, std::mt19937_64& rng, int& tries) {
+    int bits = countBits(mask);
+    int size = 1 << bits;
+    std::vector<u64> occupancies(size);
+    std::vector<u64> attacks(size);
+    u64 occ = 0;
+    for (int n = 0; n < size; n++) {
+        occupancies[n] = occ;
+        attacks[n] = isBishop ? slidingBishopAttacksForInitialization(s, occ) : slidingRookAttacksForInitialization(s, occ);
+        occ = (occ - mask) & mask;
+    }
+    // Stamping each slot with the attempt number avoids clearing the table every try.
+    std::vector<u64> used(size);
+    std::vector<int> epoch(size, 0);
+    for (tries = 1;; tries++) {
+        u64 magic = rng() & rng() & rng();
+        if (countBits((mask * magic) & 0xFF00000000000000ULL) < 6)
+            continue;
+        bool ok = true;
+        for (int n = 0; n < size && ok; n++) {
+            int index = static_cast<int>((occupancies[n] * magic) >> (64 - bits));
+            if (epoch[index] != tries) {
+                epoch[index] = tries;
+                used[index] = attacks[n];
+            } else if (used[index] != attacks[n]) {
+                ok = false;
+            }
+        }
+        if (ok)
+            return magic;
+    }
+}
+
+static void printTable(const std::string& name, const std::vector<u64>& magics) {
+    std::cout << "constexpr std::array<u64, 64> " << name << " = {" << std::endl;
+    for (int s = 0; s < 64; s++) {
+        if (s % 4 == 0)
+            std::cout << "    ";
+        std::cout << "0x" << std::hex << magics[s] << std::dec << "ULL,";
+        std::cout << (s % 4 == 3 ? "\n" : " ");
+    }
+    std::cout << "};" << std::endl << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = argc > 1 ? std::stoull(argv[1]) : 728;
+    std::mt19937_64 rng(seed);
+    std::vector<u64> rook(64);
+    std::vector<u64> bishop(64);
+    int totalTries = 0;
+    size_t rookSlots = 0;
+    size_t bishopSlots = 0;
+    for (int s = a1; s <= h8; s++) {
+        int tries = 0;
+        rook[s] = findMagic(static_cast<Square>(s), rookMasks[s], false, rng, tries);
+        totalTries += tries;
+        bishop[s] = findMagic(static_cast<Square>(s), bishopMasks[s], true, rng, tries);
+        totalTries += tries;
+        rookSlots += size_t(1) << countBits(rookMasks[s]);
+        bishopSlots += size_t(1) << countBits(bishopMasks[s]);
+    }
+    printTable("rookMagics", rook);
+    printTable("bishopMagics", bishop);
+    size_t fancyBytes = (rookSlots + bishopSlots) * sizeof(u64);
+    size_t fixedBytes = size_t(64) * (4096 + 512) * sizeof(u64);
+    std::cout << "// " << totalTries << " candidates tried, seed " << seed << std::endl;
+    std::cout << "// rook slots " << rookSlots << ", bishop slots " << bishopSlots << ", "
+              << fancyBytes / 1024 << " KB (fixed 64x4096 + 64x512 layout: " << fixedBytes / 1024 << " KB)" << std::endl;
+    return 0;
+}